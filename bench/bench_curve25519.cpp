@@ -0,0 +1,108 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <array>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "curve25519/mycurve25519.h"
+
+
+static void BM_Curve25519_scalarmult_base(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    std::vector<std::array<uint8_t, 32>> scalars(n);
+    std::vector<curve25519::ge_p3> points(n);
+    for (auto& s : scalars)
+        curve25519::sc_random(s.data());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < n; ++i)
+            curve25519::x25519_ge_scalarmult_base(&points[i], scalars[i].data());
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Curve25519_scalarmult_base)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Curve25519_scalarmult_base_batch(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    std::vector<std::array<uint8_t, 32>> scalars(n);
+    std::vector<curve25519::ge_p3> points(n);
+    for (auto& s : scalars)
+        curve25519::sc_random(s.data());
+
+    for (auto _ : state)
+    {
+        curve25519::x25519_ge_scalarmult_base_batch(points.data(), scalars.data()->data(), n);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Curve25519_scalarmult_base_batch)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Curve25519_scalarmult(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    std::vector<std::array<uint8_t, 32>> scalars(n);
+    std::vector<curve25519::ge_p3> bases(n);
+    std::vector<curve25519::ge_p2> points(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        curve25519::sc_random(scalars[i].data());
+        curve25519::x25519_ge_scalarmult_base(&bases[i], scalars[i].data());
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < n; ++i)
+            curve25519::x25519_ge_scalarmult(&points[i], scalars[i].data(), &bases[i]);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Curve25519_scalarmult)->Arg(64)->Unit(benchmark::kMicrosecond);
+
+
+static void BM_Curve25519_scalarmult_batch(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    std::vector<std::array<uint8_t, 32>> scalars(n);
+    std::vector<curve25519::ge_p3> bases(n);
+    std::vector<curve25519::ge_p2> points(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        curve25519::sc_random(scalars[i].data());
+        curve25519::x25519_ge_scalarmult_base(&bases[i], scalars[i].data());
+    }
+
+    for (auto _ : state)
+    {
+        curve25519::x25519_ge_scalarmult_batch(points.data(), scalars.data()->data(), bases.data(), n);
+        benchmark::DoNotOptimize(points.data());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_Curve25519_scalarmult_batch)->Arg(64)->Unit(benchmark::kMicrosecond);
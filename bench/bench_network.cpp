@@ -0,0 +1,84 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <benchmark/benchmark.h>
+#include "network/shaped_connection.hpp"
+#include "network/shared_memory_connection.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+
+
+// Random OTs between two threads connected by an emulated network.
+template <class Protocol>
+static void run_shaped(benchmark::State& state, const NetworkProfile& profile) {
+    const size_t n = state.range(0);
+    auto conn_pair = SharedMemoryConnection::make_pair(1 << 20);
+    ShapedConnection connection_s(*conn_pair.first, profile);
+    ShapedConnection connection_r(*conn_pair.second, profile);
+    Protocol ot_s(connection_s);
+    Protocol ot_r(connection_r);
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 2;
+    }
+    std::vector<ot_key_t> output_s(2 * n);
+    std::vector<ot_key_t> output_r(n);
+
+    for (auto _ : state)
+    {
+        auto fut{std::async(std::launch::async, [&ot_s, &output_s, n] { ot_s.send_into(output_s.data(), n); })};
+        ot_r.recv_into(output_r.data(), choices);
+        fut.get();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// IKNP03 extension including the HL17 base OTs.
+class OT_IKNP03_HL17
+{
+public:
+    OT_IKNP03_HL17(Connection& connection)
+        : base_ot_(connection), ot_(connection, base_ot_) {}
+    void send_into(ot_key_t* output, size_t number_ots) { ot_.send_into(output, number_ots); }
+    void recv_into(ot_key_t* output, const std::vector<bool>& choices) { ot_.recv_into(output, choices); }
+private:
+    OT_HL17 base_ot_;
+    OTExtension ot_;
+};
+
+static void BM_OT_HL17_shaped(benchmark::State& state, NetworkProfile profile) {
+    run_shaped<OT_HL17>(state, profile);
+}
+BENCHMARK_CAPTURE(BM_OT_HL17_shaped, lan, NetworkProfile::lan())
+    ->Arg(128)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_OT_HL17_shaped, wan, NetworkProfile::wan())
+    ->Arg(128)->Arg(1024)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_OT_IKNP03_shaped(benchmark::State& state, NetworkProfile profile) {
+    run_shaped<OT_IKNP03_HL17>(state, profile);
+}
+BENCHMARK_CAPTURE(BM_OT_IKNP03_shaped, lan, NetworkProfile::lan())
+    ->Arg(1 << 16)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_OT_IKNP03_shaped, wan, NetworkProfile::wan())
+    ->Arg(1 << 16)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <benchmark/benchmark.h>
+#include "network/devnull_connection.hpp"
+#include "network/dummy_connection.hpp"
+#include "ot/ot_co15.hpp"
+
+
+// Sender side of a batch of OTs after receiving the receiver's points.
+static void BM_OT_CO15_send_1_batch(benchmark::State& state) {
+    DevNullConnection connection;
+    OT_CO15 ot{connection};
+
+    const size_t n = state.range(0);
+    OT_CO15::Sender_SharedState sss;
+    OT_CO15::Receiver_SharedState rss;
+    std::vector<OT_CO15::Receiver_State> rs(n);
+    std::array<uint8_t, OT_CO15::curve25519_ge_byte_size> msg_s0;
+    std::vector<std::array<uint8_t, OT_CO15::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<ot_key_t> res_s(2 * n);
+
+    ot.send_0(sss, msg_s0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1(rss, msg_s0);
+    ot.recv_2_batch(rs.data(), rss, msgs_r1.data(), n);
+
+    for (auto _ : state)
+    {
+        ot.send_1_batch(sss, res_s.data(), msg_s0, msgs_r1.data(), n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_CO15_send_1_batch)->Arg(128)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+// Both parties of parallel_send_into/parallel_recv_into with range(1) threads.
+static void BM_OT_CO15_parallel_send(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t number_threads = state.range(1);
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_CO15 ot_s(*conn_pair.first);
+    OT_CO15 ot_r(*conn_pair.second);
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 2;
+    }
+    std::vector<ot_key_t> output_s(2 * n);
+    std::vector<ot_key_t> output_r(n);
+
+    for (auto _ : state)
+    {
+        auto fut{std::async(std::launch::async, [&ot_s, &output_s, n, number_threads]
+            {
+                ot_s.parallel_send_into(output_s.data(), n, number_threads);
+            })};
+        ot_r.parallel_recv_into(output_r.data(), choices, number_threads);
+        fut.get();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_CO15_parallel_send)->Args({1024, 1})->Args({1024, 4})->UseRealTime()->Unit(benchmark::kMillisecond);
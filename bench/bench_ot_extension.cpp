@@ -0,0 +1,175 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <benchmark/benchmark.h>
+#include "network/dummy_connection.hpp"
+#include "network/stats_connection.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+#include "ot/ot_kk13.hpp"
+#include "ot/ot_silent.hpp"
+#include "util/gf128.hpp"
+
+
+// Both parties of the OT extension after the base OTs.
+static void run_ot_extension(benchmark::State& state, bool active_security) {
+    const size_t n = state.range(0);
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot_s(*conn_pair.first);
+    OT_HL17 base_ot_r(*conn_pair.second);
+    OTExtension ot_s(*conn_pair.first, base_ot_s, active_security);
+    OTExtension ot_r(*conn_pair.second, base_ot_r, active_security);
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 2;
+    }
+    std::vector<ot_key_t> output_s(2 * n);
+    std::vector<ot_key_t> output_r(n);
+
+    auto run = [&] {
+        auto fut{std::async(std::launch::async, [&ot_s, &output_s, n] { ot_s.send_into(output_s.data(), n); })};
+        ot_r.recv_into(output_r.data(), choices);
+        fut.get();
+    };
+    run();
+
+    for (auto _ : state)
+    {
+        run();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_OT_IKNP03(benchmark::State& state) {
+    run_ot_extension(state, false);
+}
+BENCHMARK(BM_OT_IKNP03)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_OT_KOS15(benchmark::State& state) {
+    run_ot_extension(state, true);
+}
+BENCHMARK(BM_OT_KOS15)->Arg(1 << 20)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Silent random OTs with base OTs from IKNP03 on top of HL17, including the
+// communication per OT.
+static void BM_OT_silent(benchmark::State& state) {
+    const size_t n = state.range(0);
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats_s(*conn_pair.first);
+    StatsConnection stats_r(*conn_pair.second);
+    OT_HL17 base_ot_s(stats_s);
+    OT_HL17 base_ot_r(stats_r);
+    OTExtension extension_s(stats_s, base_ot_s);
+    OTExtension extension_r(stats_r, base_ot_r);
+    SilentOT ot_s(stats_s, extension_s);
+    SilentOT ot_r(stats_r, extension_r);
+    std::vector<ot_key_t> output_s(2 * n);
+    std::vector<ot_key_t> output_r(n);
+
+    auto run = [&] {
+        auto fut{std::async(std::launch::async, [&ot_s, &output_s, n] { ot_s.send_random_into(output_s.data(), n); })};
+        ot_r.recv_random_into(output_r.data(), n);
+        fut.get();
+    };
+    run();
+    stats_s.reset();
+    stats_r.reset();
+
+    for (auto _ : state)
+    {
+        run();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    const auto bytes = stats_s.snapshot().bytes_sent + stats_r.snapshot().bytes_sent;
+    state.counters["bytes_per_ot"] = static_cast<double>(bytes) / (state.iterations() * n);
+}
+BENCHMARK(BM_OT_silent)->Arg(1 << 20)->Arg(1 << 22)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// 1-out-of-N random OTs (KK13) with base OTs from HL17 for N = range(1),
+// including the communication per OT.
+static void BM_OT_KK13(benchmark::State& state) {
+    const size_t n = state.range(0);
+    const size_t number_messages = state.range(1);
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats_s(*conn_pair.first);
+    StatsConnection stats_r(*conn_pair.second);
+    OT_HL17 base_ot_s(stats_s);
+    OT_HL17 base_ot_r(stats_r);
+    OT_KK13 ot_s(stats_s, base_ot_s, number_messages);
+    OT_KK13 ot_r(stats_r, base_ot_r, number_messages);
+    std::vector<size_t> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % number_messages;
+    }
+    std::vector<ot_key_t> output_s(number_messages * n);
+    std::vector<ot_key_t> output_r(n);
+
+    auto run = [&] {
+        auto fut{std::async(std::launch::async, [&ot_s, &output_s, n] { ot_s.send_into(output_s.data(), n); })};
+        ot_r.recv_into(output_r.data(), choices);
+        fut.get();
+    };
+    run();
+    stats_s.reset();
+    stats_r.reset();
+
+    for (auto _ : state)
+    {
+        run();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    const auto bytes = stats_s.snapshot().bytes_sent + stats_r.snapshot().bytes_sent;
+    state.counters["bytes_per_ot"] = static_cast<double>(bytes) / (state.iterations() * n);
+}
+BENCHMARK(BM_OT_KK13)->Args({1 << 16, 2})->Args({1 << 16, 16})->Args({1 << 16, 256})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+
+// The GF(2^128) inner product of the correlation check for a million OTs,
+// which is computed by both parties.
+static void BM_GF128_check(benchmark::State& state, GF128Impl impl) {
+    const auto default_impl = gf128_get_impl();
+    if (!gf128_set_impl(impl))
+    {
+        state.SkipWithError("not supported by the CPU");
+        return;
+    }
+    const size_t n = state.range(0);
+    auto rows = random_bytes(16 * n);
+    auto chi = random_bytes(16 * n);
+    std::array<uint8_t, 16> result;
+
+    for (auto _ : state)
+    {
+        gf128_sum_t sum{};
+        gf128_mul_add(sum, rows.data(), chi.data(), n);
+        gf128_reduce(result.data(), sum);
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    gf128_set_impl(default_impl);
+}
+BENCHMARK_CAPTURE(BM_GF128_check, portable, GF128Impl::portable)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_GF128_check, pclmul, GF128Impl::pclmul)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
@@ -21,6 +21,7 @@
 // SOFTWARE.
 
 #include <benchmark/benchmark.h>
+#include "curve25519/mycurve25519.h"
 #include "network/devnull_connection.hpp"
 #include "ot/ot_hl17.hpp"
 
@@ -50,3 +51,153 @@ static void BM_OT_HL17_no_network(benchmark::State& state) {
 }
 BENCHMARK(BM_OT_HL17_no_network)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
 
+
+
+// Sender side of a batch of OTs with an S/T per OT.
+static void BM_OT_HL17_send_2_batch(benchmark::State& state) {
+    DevNullConnection connection;
+    OT_HL17 ot{connection};
+
+    const size_t n = state.range(0);
+    std::vector<OT_HL17::Sender_State> ss(n);
+    std::vector<OT_HL17::Receiver_State> rs(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_s0(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> S_bytes(n);
+    std::vector<ot_key_t> res_s(2 * n);
+
+    ot.send_0_batch(ss.data(), msgs_s0.data(), n);
+    ot.send_1_batch(ss.data(), msgs_s0.data(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1_batch(rs.data(), msgs_r1.data(), S_bytes.data(), msgs_s0.data(), n);
+
+    for (auto _ : state)
+    {
+        ot.send_2_batch(ss.data(), res_s.data(), msgs_s0.data(), msgs_r1.data(), n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_HL17_send_2_batch)->Arg(128)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+// Sender side of a batch of OTs with a single S/T.
+static void BM_OT_HL17_send_2_batch_shared(benchmark::State& state) {
+    DevNullConnection connection;
+    OT_HL17 ot{connection, true};
+
+    const size_t n = state.range(0);
+    OT_HL17::Sender_SharedState sss;
+    OT_HL17::Receiver_SharedState rss;
+    std::vector<OT_HL17::Receiver_State> rs(n);
+    std::array<uint8_t, OT_HL17::curve25519_ge_byte_size> msg_s0;
+    std::array<uint8_t, OT_HL17::curve25519_ge_byte_size> S_bytes;
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<ot_key_t> res_s(2 * n);
+
+    ot.send_0(sss, msg_s0);
+    ot.send_1(sss, msg_s0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1(rss, S_bytes, msg_s0);
+    ot.recv_1_batch(rs.data(), rss, msgs_r1.data(), n);
+
+    for (auto _ : state)
+    {
+        ot.send_2_batch(sss, res_s.data(), msg_s0, msgs_r1.data(), n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_HL17_send_2_batch_shared)->Arg(128)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+// Receiver side of a batch of OTs with an S/T per OT.
+static void BM_OT_HL17_recv_1_batch(benchmark::State& state) {
+    DevNullConnection connection;
+    OT_HL17 ot{connection};
+
+    const size_t n = state.range(0);
+    std::vector<OT_HL17::Sender_State> ss(n);
+    std::vector<OT_HL17::Receiver_State> rs(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_s0(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> S_bytes(n);
+
+    ot.send_0_batch(ss.data(), msgs_s0.data(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+
+    for (auto _ : state)
+    {
+        ot.recv_1_batch(rs.data(), msgs_r1.data(), S_bytes.data(), msgs_s0.data(), n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_HL17_recv_1_batch)->Arg(128)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+// R = T^c * g^x for random choices c, as in recv_1: the variable time
+// version branches on c, the constant time version always adds and selects
+// the neutral element or T with a conditional move.
+static void setup_choice(std::vector<curve25519::ge_p3>& Rs, std::vector<curve25519::ge_cached>& Ts,
+                         std::vector<uint8_t>& choices) {
+    std::array<uint8_t, 32> x;
+    curve25519::ge_p3 T;
+    for (size_t i = 0; i < Rs.size(); ++i)
+    {
+        curve25519::sc_random(x.data());
+        curve25519::x25519_ge_scalarmult_base(&Rs[i], x.data());
+        curve25519::sc_random(x.data());
+        curve25519::x25519_ge_scalarmult_base(&T, x.data());
+        curve25519::x25519_ge_p3_to_cached(&Ts[i], &T);
+        choices[i] = x[1] & 1;
+    }
+}
+
+static void BM_OT_HL17_choice_branch(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<curve25519::ge_p3> Rs(n);
+    std::vector<curve25519::ge_cached> Ts(n);
+    std::vector<uint8_t> choices(n);
+    setup_choice(Rs, Ts, choices);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (choices[i] == 1)
+            {
+                curve25519::ge_p1p1 R_p1p1;
+                curve25519::x25519_ge_add(&R_p1p1, &Rs[i], &Ts[i]);
+                curve25519::x25519_ge_p1p1_to_p3(&Rs[i], &R_p1p1);
+            }
+        }
+        benchmark::DoNotOptimize(Rs.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_HL17_choice_branch)->Arg(1024)->Unit(benchmark::kMicrosecond);
+
+static void BM_OT_HL17_choice_cmov(benchmark::State& state) {
+    const size_t n = state.range(0);
+    std::vector<curve25519::ge_p3> Rs(n);
+    std::vector<curve25519::ge_cached> Ts(n);
+    std::vector<uint8_t> choices(n);
+    setup_choice(Rs, Ts, choices);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            curve25519::x25519_ge_add_cmov(&Rs[i], &Rs[i], &Ts[i], choices[i]);
+        }
+        benchmark::DoNotOptimize(Rs.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_OT_HL17_choice_cmov)->Arg(1024)->Unit(benchmark::kMicrosecond);
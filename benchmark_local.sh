@@ -0,0 +1,39 @@
+#!/bin/sh
+
+# Like benchmark.sh, but runs both parties on this machine and emulates the
+# network between them (see the --network, --rtt, --bandwidth and --jitter
+# options of baseOT).
+
+set -e
+
+BINARY_PATH=./baseOT
+
+
+for NETWORK in lan wan; do
+    for N in 128 256 1024; do
+        for T in 1 2 4 8; do
+            echo "[+] benchmarking NETWORK=$NETWORK, N=$N, T=$T"
+            /usr/bin/time -v $BINARY_PATH \
+                -r 0 \
+                -o out_sender.txt \
+                -n $N \
+                -a 127.0.0.1 \
+                -t $T \
+                --network $NETWORK \
+                2> "baseOTs_${NETWORK}_0_${N}_${T}.txt" &
+            PID=$!
+            sleep .1s
+            /usr/bin/time -v $BINARY_PATH \
+                -r 1 \
+                -o out_receiver.txt \
+                -a 127.0.0.1 \
+                -n $N \
+                -t $T \
+                --network $NETWORK \
+                2> "baseOTs_${NETWORK}_1_${N}_${T}.txt"
+            wait $PID
+            grep wall baseOTs_${NETWORK}_*_${N}_${T}.txt
+            sleep 1s
+        done
+    done
+done
@@ -26,10 +26,15 @@
 #include <iostream>
 #include <fstream>
 #include <boost/program_options.hpp>
+#include "network/shaped_connection.hpp"
+#include "network/stats_connection.hpp"
 #include "network/tcp_connection.hpp"
 #include "ot/ot_co15.hpp"
+#include "ot/ot_extension.hpp"
 #include "ot/ot_hl17.hpp"
+#include "ot/ot_silent.hpp"
 #include "util/options.hpp"
+#include "util/threading.hpp"
 
 
 namespace po = boost::program_options;
@@ -44,7 +49,15 @@ struct Options
     std::string input_file;
     std::string output_file;
     OT_Protocol ot_protocol;
+    OT_Protocol base_ot_protocol;
+    bool hl17_shared_state;
+    size_t chunk_size;
     size_t repetitions;
+    bool pin_threads;
+    int numa_node;
+    SocketOptions socket_options;
+    NetworkProfile network_profile;
+    bool shape_network;
 };
 
 void print_help(std::ostream& stream, const po::options_description& desc)
@@ -54,6 +67,12 @@ void print_help(std::ostream& stream, const po::options_description& desc)
            << "Available protocols:\n"
            << "  HL17   Hauck, Loss (2017) https://eprint.iacr.org/2017/1011\n"
            << "  CO15   Chou, Orlandi (2015) http://eprint.iacr.org/2015/267\n"
+           << "  IKNP03 Ishai, Kilian, Nissim, Petrank (2003) OT extension\n"
+           << "         (uses the protocol given by --base-ot for the base OTs)\n"
+           << "  KOS15  Keller, Orsini, Scholl (2015) https://eprint.iacr.org/2015/546\n"
+           << "         (IKNP03 with active security, uses --base-ot as well)\n"
+           << "  SILENT Silent OT from LPN with an expand-accumulate code, base OTs from\n"
+           << "         IKNP03 on top of --base-ot\n"
            << "\n";
 }
 
@@ -70,7 +89,22 @@ Options parse_arguments(int argc, char* argv[])
         ("input,i", po::value<std::string>()->default_value("in.txt"), "Input text file (only for receiver)")
         ("output,o", po::value<std::string>()->default_value("out.txt"), "Output text file (for sender and receiver resp.)")
         ("ot", po::value<OT_Protocol>()->default_value(OT_Protocol::HL17), "OT Protocol to use")
+        ("base-ot", po::value<OT_Protocol>()->default_value(OT_Protocol::HL17), "Base OT Protocol to use for OT extension")
+        ("hl17-shared-state", po::bool_switch(), "Use a single S/T for all OTs of a batch in HL17")
+        ("chunk-size", po::value<size_t>()->default_value(0), "Pipeline HL17 batches in chunks of this many OTs (0 to disable)")
         ("repetitions", po::value<size_t>()->default_value(1), "Number of repetitions")
+        ("pin-threads", po::bool_switch(), "Pin the worker threads to individual cores")
+        ("numa-node", po::value<int>()->default_value(-1), "Run the worker threads on this NUMA node (-1 for any)")
+        ("low-latency", po::bool_switch(), "Use the low latency socket profile (TCP_NODELAY and TCP_QUICKACK)")
+        ("tcp-nodelay", po::bool_switch(), "Disable Nagle's algorithm")
+        ("tcp-quickack", po::bool_switch(), "Acknowledge received data immediately")
+        ("sndbuf", po::value<int>()->default_value(0), "Socket send buffer size (0 for the default)")
+        ("rcvbuf", po::value<int>()->default_value(0), "Socket receive buffer size (0 for the default)")
+        ("busy-poll", po::value<int>()->default_value(0), "Busy poll for this many microseconds when waiting for data")
+        ("network", po::value<std::string>()->default_value("none"), "Emulate a network (none, lan, or wan) on top of the connection")
+        ("rtt", po::value<double>(), "Emulated round trip time in ms")
+        ("bandwidth", po::value<double>(), "Emulated bandwidth in Mbit/s (0 for unlimited)")
+        ("jitter", po::value<double>(), "Emulated jitter in ms")
     ;
     po::variables_map vm;
     try
@@ -100,7 +134,47 @@ Options parse_arguments(int argc, char* argv[])
     options.input_file = vm["input"].as<std::string>();
     options.output_file = vm["output"].as<std::string>();
     options.ot_protocol = vm["ot"].as<OT_Protocol>();
+    options.base_ot_protocol = vm["base-ot"].as<OT_Protocol>();
+    if (options.base_ot_protocol == OT_Protocol::IKNP03 || options.base_ot_protocol == OT_Protocol::KOS15
+        || options.base_ot_protocol == OT_Protocol::SILENT)
+    {
+        std::cerr << "Error parsing arguments: base OT protocol cannot be an OT extension\n"
+                  << "\n";
+        print_help(std::cerr, desc);
+        exit(EXIT_FAILURE);
+    }
+    options.hl17_shared_state = vm["hl17-shared-state"].as<bool>();
+    options.chunk_size = vm["chunk-size"].as<size_t>();
     options.repetitions = vm["repetitions"].as<size_t>();
+    options.pin_threads = vm["pin-threads"].as<bool>();
+    options.numa_node = vm["numa-node"].as<int>();
+    if (vm["low-latency"].as<bool>())
+        options.socket_options = SocketOptions::low_latency();
+    options.socket_options.no_delay |= vm["tcp-nodelay"].as<bool>();
+    options.socket_options.quick_ack |= vm["tcp-quickack"].as<bool>();
+    options.socket_options.send_buffer_size = vm["sndbuf"].as<int>();
+    options.socket_options.receive_buffer_size = vm["rcvbuf"].as<int>();
+    options.socket_options.busy_poll = vm["busy-poll"].as<int>();
+    const auto network = vm["network"].as<std::string>();
+    options.shape_network = network != "none" || vm.count("rtt") || vm.count("bandwidth") || vm.count("jitter");
+    if (network == "lan")
+        options.network_profile = NetworkProfile::lan();
+    else if (network == "wan")
+        options.network_profile = NetworkProfile::wan();
+    else if (network != "none")
+    {
+        std::cerr << "Error parsing arguments: unknown network " << network << "\n"
+                  << "\n";
+        print_help(std::cerr, desc);
+        exit(EXIT_FAILURE);
+    }
+    // each party delays its outgoing data by half of the given RTT
+    if (vm.count("rtt"))
+        options.network_profile.rtt = std::chrono::microseconds(static_cast<int64_t>(1000 * vm["rtt"].as<double>()));
+    if (vm.count("bandwidth"))
+        options.network_profile.bandwidth = 1e6 * vm["bandwidth"].as<double>();
+    if (vm.count("jitter"))
+        options.network_profile.jitter = std::chrono::microseconds(static_cast<int64_t>(1000 * vm["jitter"].as<double>()));
     return options;
 }
 
@@ -119,30 +193,46 @@ std::vector<bool> parse_inputfile(const Options& options)
 }
 
 void write_outputfile_receiver(const Options& options,
-                               const std::vector<bytes_t> output)
+                               const std::vector<ot_key_t>& output)
 {
     std::ofstream f(options.output_file);
     for (auto& o : output)
     {
-        f << hexlify(o, true) << "\n";
+        f << hexlify(o.data(), o.size(), true) << "\n";
     }
 }
 
 void write_outputfile_sender(const Options& options,
-                             const std::vector<std::pair<bytes_t, bytes_t>> output)
+                             const std::vector<ot_key_t>& output)
 {
     std::ofstream f(options.output_file);
-    for (const auto& [o0, o1] : output)
+    for (size_t i = 0; i < output.size() / 2; ++i)
     {
-        f << hexlify(o0, true) << "," << hexlify(o1, true) << "\n";
+        const auto& o0 = output[2 * i];
+        const auto& o1 = output[2 * i + 1];
+        f << hexlify(o0.data(), o0.size(), true) << ","
+          << hexlify(o1.data(), o1.size(), true) << "\n";
     }
 }
 
+std::unique_ptr<RandomOT> make_hl17(Connection& connection, const Options& options)
+{
+    auto ot = std::make_unique<OT_HL17>(connection, options.hl17_shared_state);
+    ot->set_chunk_size(options.chunk_size);
+    return ot;
+}
+
 
 int main(int argc, char* argv[])
 {
     auto options{parse_arguments(argc, argv)};
 
+    GlobalThreadPoolConfig thread_pool_config;
+    thread_pool_config.number_threads = options.threads;
+    thread_pool_config.pin_threads = options.pin_threads;
+    thread_pool_config.numa_node = options.numa_node;
+    configure_global_thread_pool(thread_pool_config);
+
     boost::asio::io_context io_context;
     std::thread io_thread;
 
@@ -158,14 +248,41 @@ int main(int argc, char* argv[])
         auto connection(TCPConnection::from_role(options.role,
                                                  io_context,
                                                  options.address,
-                                                 options.port));
+                                                 options.port,
+                                                 options.socket_options));
+        std::unique_ptr<ShapedConnection> shaped_connection;
+        if (options.shape_network)
+            shaped_connection = std::make_unique<ShapedConnection>(*connection, options.network_profile);
+        Connection& link = shaped_connection ? static_cast<Connection&>(*shaped_connection) : *connection;
+        StatsConnection stats_connection(link);
+        std::unique_ptr<RandomOT> base_ot;
+        std::unique_ptr<RandomOT> extension;
         std::unique_ptr<RandomOT> ot;
         switch (options.ot_protocol)
         {
             case OT_Protocol::CO15:
-                ot = std::make_unique<OT_CO15>(*connection);
+                ot = std::make_unique<OT_CO15>(stats_connection);
+                break;
             case OT_Protocol::HL17:
-                ot = std::make_unique<OT_HL17>(*connection);
+                ot = make_hl17(stats_connection, options);
+                break;
+            case OT_Protocol::IKNP03:
+            case OT_Protocol::KOS15:
+                if (options.base_ot_protocol == OT_Protocol::CO15)
+                    base_ot = std::make_unique<OT_CO15>(stats_connection);
+                else
+                    base_ot = make_hl17(stats_connection, options);
+                ot = std::make_unique<OTExtension>(stats_connection, *base_ot,
+                                                   options.ot_protocol == OT_Protocol::KOS15);
+                break;
+            case OT_Protocol::SILENT:
+                if (options.base_ot_protocol == OT_Protocol::CO15)
+                    base_ot = std::make_unique<OT_CO15>(stats_connection);
+                else
+                    base_ot = make_hl17(stats_connection, options);
+                extension = std::make_unique<OTExtension>(stats_connection, *base_ot);
+                ot = std::make_unique<SilentOT>(stats_connection, *extension);
+                break;
         };
 
         for (size_t i = 0; i < options.repetitions; ++i)
@@ -174,21 +291,21 @@ int main(int argc, char* argv[])
 
             if (options.role == Role::server)
             {
-                std::vector<std::pair<bytes_t, bytes_t>> output;
+                std::vector<ot_key_t> output(2 * options.number_ots);
                 if (options.threads == 1)
-                    output = ot->send(options.number_ots);
+                    ot->send_into(output.data(), options.number_ots);
                 else
-                    output = ot->parallel_send(options.number_ots, options.threads);
+                    ot->parallel_send_into(output.data(), options.number_ots, options.threads);
                 write_outputfile_sender(options, output);
             }
             else  // Role::client
             {
                 auto choices = parse_inputfile(options);
-                std::vector<bytes_t> output;
+                std::vector<ot_key_t> output(options.number_ots);
                 if (options.threads == 1)
-                    output = ot->recv(choices);
+                    ot->recv_into(output.data(), choices);
                 else
-                    output = ot->parallel_recv(choices, options.threads);
+                    ot->parallel_recv_into(output.data(), choices, options.threads);
                 write_outputfile_receiver(options, output);
             }
             auto t_end = clock.now();
@@ -196,16 +313,19 @@ int main(int argc, char* argv[])
             auto time_round = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
             times.push_back(time_round);
         }
-        auto time_total = std::accumulate(times.cbegin(), times.cend(), 0);
+        auto time_total = std::accumulate(times.cbegin(), times.cend(), decltype(times)::value_type{0});
         auto time_per_round = time_total / options.repetitions;
-        auto time_per_ot = time_total / (options.repetitions * options.number_ots);
-        std::cout << "Protocol: " << options.ot_protocol << "\n"
-                  << "Role: " << (options.role == Role::server ? "Sender" : "Receiver") << "\n"
+        auto time_per_ot = static_cast<double>(time_total) / (options.repetitions * options.number_ots);
+        std::cout << "Protocol: " << options.ot_protocol << "\n";
+        if (options.ot_protocol != OT_Protocol::CO15 && options.ot_protocol != OT_Protocol::HL17)
+            std::cout << "Base Protocol: " << options.base_ot_protocol << "\n";
+        std::cout << "Role: " << (options.role == Role::server ? "Sender" : "Receiver") << "\n"
                   << "Random-OTs: " << options.number_ots << "\n"
                   << "Threads: " << options.threads << "\n"
                   << "Repetitions: " << options.repetitions << "\n"
                   << "Time (avg.): " << time_per_round << " us\n"
-                  << "Time (per OT): " << time_per_ot << " us\n";
+                  << "Time (per OT): " << time_per_ot << " us\n"
+                  << stats_connection.snapshot();
 
     }
     catch (std::exception &e)
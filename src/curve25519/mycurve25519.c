@@ -1961,13 +1961,27 @@ void x25519_ge_scalarmult_base(ge_p3 *h, const uint8_t *a) {
 
 #endif
 
-static void cmov_cached(ge_cached *t, ge_cached *u, uint8_t b) {
+static void cmov_cached(ge_cached *t, const ge_cached *u, uint8_t b) {
   fe_cmov(&t->YplusX, &u->YplusX, b);
   fe_cmov(&t->YminusX, &u->YminusX, b);
   fe_cmov(&t->Z, &u->Z, b);
   fe_cmov(&t->T2d, &u->T2d, b);
 }
 
+// r = p + b * q in constant time, i.e. the addition is always computed, but
+// with the neutral element if b == 0.
+//
+// Preconditions: b in {0,1}.
+void x25519_ge_add_cmov(ge_p3 *r, const ge_p3 *p, const ge_cached *q,
+                        uint8_t b) {
+  ge_cached t;
+  ge_p1p1 s;
+  ge_cached_0(&t);
+  cmov_cached(&t, q, b);
+  x25519_ge_add(&s, p, &t);
+  x25519_ge_p1p1_to_p3(r, &s);
+}
+
 // r = scalar * A.
 // where a = a[0]+256*a[1]+...+256^31 a[31].
 void x25519_ge_scalarmult(ge_p2 *r, const uint8_t *scalar, const ge_p3 *A) {
@@ -3071,12 +3085,200 @@ void sc_random(uint8_t s[32])
 
 void x25519_ge_p2_to_p3(ge_p3 *r, const ge_p2 *p)
 {
-    fe_copy(&r->X, &p->X);
-    fe_copy(&r->Y, &p->Y);
-    fe_copy(&r->Z, &p->Z);
-    /* X * Y / Z */
+    /* (X:Y:Z) = (XZ:YZ:Z^2) with T = XY, avoids inverting Z */
     fe_mul_ttt(&r->T, &p->X, &p->Y);
-    fe tmp;
-    fe_invert(&tmp, &p->Z);
-    fe_mul_ttt(&r->T, &r->T, &tmp);
+    fe_mul_ttt(&r->X, &p->X, &p->Z);
+    fe_mul_ttt(&r->Y, &p->Y, &p->Z);
+    fe_sq_tt(&r->Z, &p->Z);
+}
+
+
+// Point decompression computes x = uv^3 (uv^7)^((q-5)/8), i.e. one
+// exponentiation per point and no inversion.  Unlike for the encoding, there
+// is no field operation that can be shared between the points, so the batch
+// version only saves the per-call overhead and keeps the points contiguous.
+int x25519_ge_frombytes_vartime_batch(ge_p3 *h, const uint8_t *s, size_t n)
+{
+    int ret = 1;
+    size_t i;
+    for (i = 0; i < n; ++i) {
+        ret &= x25519_ge_frombytes_vartime(&h[i], s + 32 * i);
+    }
+    return ret;
+}
+
+
+// Number of points whose encoding shares one field inversion.
+#define GE_TOBYTES_BATCH_SIZE 128
+
+// out[i] = 1/in[i] for i < n using a single inversion:
+// With acc[i] = in[0] * ... * in[i], we have
+// 1/in[i] = acc[i-1] / acc[i] and 1/acc[i-1] = in[i] / acc[i].
+static void fe_invert_batch(fe *out, const fe *in, size_t n) {
+  fe acc[GE_TOBYTES_BATCH_SIZE];
+  fe inv;
+  size_t i;
+
+  assert(0 < n && n <= GE_TOBYTES_BATCH_SIZE);
+
+  fe_copy(&acc[0], &in[0]);
+  for (i = 1; i < n; ++i) {
+    fe_mul_ttt(&acc[i], &acc[i - 1], &in[i]);
+  }
+
+  fe_invert(&inv, &acc[n - 1]);
+
+  for (i = n - 1; i > 0; --i) {
+    fe_mul_ttt(&out[i], &inv, &acc[i - 1]);
+    fe_mul_ttt(&inv, &inv, &in[i]);
+  }
+  fe_copy(&out[0], &inv);
+}
+
+static void ge_tobytes_recip(uint8_t s[32], const fe *X, const fe *Y,
+                             const fe *recip) {
+  fe x;
+  fe y;
+
+  fe_mul_ttt(&x, X, recip);
+  fe_mul_ttt(&y, Y, recip);
+  fe_tobytes(s, &y);
+  s[31] ^= fe_isnegative(&x) << 7;
+}
+
+// Encode the n points with coordinates X, Y, Z, where the coordinates of
+// consecutive points are stride bytes apart (i.e. the size of the point
+// type).
+static void ge_tobytes_batch_strided(uint8_t *s, const fe *X, const fe *Y,
+                                     const fe *Z, size_t stride, size_t n) {
+  fe Zs[GE_TOBYTES_BATCH_SIZE];
+  fe recip[GE_TOBYTES_BATCH_SIZE];
+  size_t i;
+
+#define GE_COORD(C, i) \
+  ((const fe *)((const uint8_t *)(C) + (i) * stride))
+
+  while (n > 0) {
+    size_t chunk = n < GE_TOBYTES_BATCH_SIZE ? n : GE_TOBYTES_BATCH_SIZE;
+    for (i = 0; i < chunk; ++i) {
+      fe_copy(&Zs[i], GE_COORD(Z, i));
+    }
+    fe_invert_batch(recip, Zs, chunk);
+    for (i = 0; i < chunk; ++i) {
+      ge_tobytes_recip(s + 32 * i, GE_COORD(X, i), GE_COORD(Y, i), &recip[i]);
+    }
+    s += 32 * chunk;
+    X = GE_COORD(X, chunk);
+    Y = GE_COORD(Y, chunk);
+    Z = GE_COORD(Z, chunk);
+    n -= chunk;
+  }
+
+#undef GE_COORD
+}
+
+void x25519_ge_tobytes_batch(uint8_t *s, const ge_p2 *h, size_t n) {
+  if (n == 0) {
+    return;
+  }
+  ge_tobytes_batch_strided(s, &h->X, &h->Y, &h->Z, sizeof(ge_p2), n);
+}
+
+void ge_p3_tobytes_batch(uint8_t *s, const ge_p3 *h, size_t n) {
+  if (n == 0) {
+    return;
+  }
+  ge_tobytes_batch_strided(s, &h->X, &h->Y, &h->Z, sizeof(ge_p3), n);
+}
+
+// Lane-parallel scalar multiplications with the vectorized field backends.
+// All backends are compiled with function specific target attributes, the
+// one used by the batch functions is selected at startup depending on the
+// features of the CPU.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define X25519_HAS_LANES
+#include "./mycurve25519_avx2.h"
+#include "./mycurve25519_lanes.h"
+#include "./mycurve25519_ifma.h"
+#include "./mycurve25519_lanes.h"
+#endif
+
+typedef struct {
+  size_t lanes;
+  void (*scalarmult_base)(ge_p3 *h, const uint8_t *a);
+  void (*scalarmult)(ge_p2 *r, const uint8_t *scalar, const ge_p3 *A);
+} x25519_lanes_impl;
+
+static const x25519_lanes_impl x25519_lanes_impls[] = {
+  [X25519_IMPL_SCALAR] = {1, x25519_ge_scalarmult_base, x25519_ge_scalarmult},
+#if defined(X25519_HAS_LANES) && !defined(OPENSSL_SMALL)
+  [X25519_IMPL_AVX2] = {4, ge_scalarmult_base_avx2, ge_scalarmult_avx2},
+  [X25519_IMPL_AVX512IFMA] = {8, ge_scalarmult_base_ifma, ge_scalarmult_ifma},
+#elif defined(X25519_HAS_LANES)
+  [X25519_IMPL_AVX2] = {4, x25519_ge_scalarmult_base, ge_scalarmult_avx2},
+  [X25519_IMPL_AVX512IFMA] = {8, x25519_ge_scalarmult_base, ge_scalarmult_ifma},
+#endif
+};
+
+static x25519_impl x25519_current_impl = X25519_IMPL_SCALAR;
+
+int x25519_impl_supported(x25519_impl impl) {
+  switch (impl) {
+    case X25519_IMPL_SCALAR:
+      return 1;
+#if defined(X25519_HAS_LANES)
+    case X25519_IMPL_AVX2:
+      return __builtin_cpu_supports("avx2");
+    case X25519_IMPL_AVX512IFMA:
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512ifma");
+#endif
+    default:
+      return 0;
+  }
+}
+
+x25519_impl x25519_get_impl(void) {
+  return x25519_current_impl;
+}
+
+int x25519_set_impl(x25519_impl impl) {
+  if (!x25519_impl_supported(impl)) {
+    return 0;
+  }
+  x25519_current_impl = impl;
+  return 1;
+}
+
+__attribute__((constructor)) static void x25519_select_impl(void) {
+#if defined(X25519_HAS_LANES)
+  __builtin_cpu_init();
+#endif
+  if (!x25519_set_impl(X25519_IMPL_AVX512IFMA)) {
+    x25519_set_impl(X25519_IMPL_AVX2);
+  }
+}
+
+void x25519_ge_scalarmult_base_batch(ge_p3 *h, const uint8_t *a, size_t n) {
+  const x25519_lanes_impl *impl = &x25519_lanes_impls[x25519_current_impl];
+  size_t i = 0;
+  for (; i + impl->lanes <= n; i += impl->lanes) {
+    impl->scalarmult_base(h + i, a + 32 * i);
+  }
+  for (; i < n; ++i) {
+    x25519_ge_scalarmult_base(h + i, a + 32 * i);
+  }
+}
+
+void x25519_ge_scalarmult_batch(ge_p2 *r, const uint8_t *scalar,
+                                const ge_p3 *A, size_t n) {
+  const x25519_lanes_impl *impl = &x25519_lanes_impls[x25519_current_impl];
+  size_t i = 0;
+  for (; i + impl->lanes <= n; i += impl->lanes) {
+    impl->scalarmult(r + i, scalar + 32 * i, A + i);
+  }
+  for (; i < n; ++i) {
+    x25519_ge_scalarmult(r + i, scalar + 32 * i, A + i);
+  }
 }
@@ -32,6 +32,7 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -122,6 +123,9 @@ void x25519_ge_p1p1_to_p2(ge_p2 *r, const ge_p1p1 *p);
 void x25519_ge_p1p1_to_p3(ge_p3 *r, const ge_p1p1 *p);
 void x25519_ge_add(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q);
 void x25519_ge_sub(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q);
+// r = p + b * q without branching on b in {0,1}.
+void x25519_ge_add_cmov(ge_p3 *r, const ge_p3 *p, const ge_cached *q,
+                        uint8_t b);
 void x25519_ge_scalarmult_small_precomp(
     ge_p3 *h, const uint8_t a[32], const uint8_t precomp_table[15 * 2 * 32]);
 void x25519_ge_scalarmult_base(ge_p3 *h, const uint8_t a[32]);
@@ -138,6 +142,35 @@ void ge_p3_tobytes(uint8_t s[32], const ge_p3 *h);
 void ge_double_scalarmult_vartime(ge_p2 *r, const uint8_t *a,
                                   const ge_p3 *A, const uint8_t *b);
 
+// Encode the n points h[0], ..., h[n-1] into the 32 * n bytes at s.  All
+// points in a chunk share a single field inversion (Montgomery's trick).
+void x25519_ge_tobytes_batch(uint8_t *s, const ge_p2 *h, size_t n);
+void ge_p3_tobytes_batch(uint8_t *s, const ge_p3 *h, size_t n);
+
+// Compute h[i] = a_i * B and r[i] = a_i * A[i] for i < n, where a_i is given
+// by the 32 bytes at a + 32 * i.  Groups of independent scalar multiplications
+// are computed in the lanes of vector registers if AVX2 or AVX-512 IFMA is
+// available.
+void x25519_ge_scalarmult_base_batch(ge_p3 *h, const uint8_t *a, size_t n);
+void x25519_ge_scalarmult_batch(ge_p2 *r, const uint8_t *a, const ge_p3 *A,
+                                size_t n);
+
+// Implementations of the batch functions.  The best one supported by the CPU
+// is selected at startup.  x25519_set_impl is meant for tests and benchmarks,
+// it is not thread safe and returns 0 if the CPU does not support impl.
+typedef enum {
+  X25519_IMPL_SCALAR = 0,
+  X25519_IMPL_AVX2 = 1,
+  X25519_IMPL_AVX512IFMA = 2,
+} x25519_impl;
+int x25519_impl_supported(x25519_impl impl);
+x25519_impl x25519_get_impl(void);
+int x25519_set_impl(x25519_impl impl);
+
+// Decode n points from the 32 * n bytes at s into h[0], ..., h[n-1].
+// Returns 1 if all points are valid, 0 otherwise.
+int x25519_ge_frombytes_vartime_batch(ge_p3 *h, const uint8_t *s, size_t n);
+
 void ge_p2_0(ge_p2 *h);
 void ge_p3_0(ge_p3 *h);
 void ge_cached_0(ge_cached *h);
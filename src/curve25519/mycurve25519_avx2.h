@@ -0,0 +1,229 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// 4-way field arithmetic with AVX2.  Only to be included by mycurve25519.c.
+// The functions carry their own target attribute, so this does not require
+// compiling with -mavx2; callers have to check the CPU features.
+//
+// Each 64-bit lane of a 256-bit vector holds one limb of an independent field
+// element.  The limbs use the radix 2^25.5 layout of the 32-bit code, i.e. an
+// element t[0], ..., t[9] represents t[0]+2^26 t[1]+2^51 t[2]+...+2^230 t[9],
+// so that the products of two limbs can be computed with vpmuludq.
+//
+// Bounds (all limbs unsigned):
+//   tight: t[even] < 2^26, t[odd] < 1.125*2^25 (produced by carry, mul, sq)
+//   loose: t[even] < 1.6*2^27, t[odd] < 1.6*2^26 (produced by add, sub)
+// so that 19 times a loose limb still fits into the 32 bits used by vpmuludq
+// and all sums of products stay below 2^63.
+
+#include <immintrin.h>
+
+#define LANES 4
+#define VN(name) name##_avx2
+#define LANES_TARGET __attribute__((target("avx2")))
+
+typedef struct { __m256i v[10]; } fe_avx2;
+typedef __m256i idx_avx2;
+
+static const uint64_t fe_avx2_mask[2] = {(1ULL << 26) - 1, (1ULL << 25) - 1};
+static const unsigned fe_avx2_shift[2] = {26, 25};
+// 2*p
+static const uint64_t fe_avx2_2p[2] = {0x7fffffe, 0x3fffffe};
+static const uint64_t fe_avx2_2p0 = 0x7ffffda;
+
+static inline LANES_TARGET __m256i fe_avx2_times19(__m256i x) {
+  return _mm256_add_epi64(
+      _mm256_add_epi64(_mm256_slli_epi64(x, 4), _mm256_slli_epi64(x, 1)), x);
+}
+
+static inline LANES_TARGET void fe_0_avx2(fe_avx2 *h) {
+  for (int i = 0; i < 10; ++i) {
+    h->v[i] = _mm256_setzero_si256();
+  }
+}
+
+static inline LANES_TARGET void fe_1_avx2(fe_avx2 *h) {
+  fe_0_avx2(h);
+  h->v[0] = _mm256_set1_epi64x(1);
+}
+
+static inline LANES_TARGET void fe_copy_avx2(fe_avx2 *h, const fe_avx2 *f) {
+  *h = *f;
+}
+
+// h = f + g (loose)
+static inline LANES_TARGET void fe_add_avx2(fe_avx2 *h, const fe_avx2 *f, const fe_avx2 *g) {
+  for (int i = 0; i < 10; ++i) {
+    h->v[i] = _mm256_add_epi64(f->v[i], g->v[i]);
+  }
+}
+
+// h = f + 2p - g (loose), g tight
+static inline LANES_TARGET void fe_sub_avx2(fe_avx2 *h, const fe_avx2 *f, const fe_avx2 *g) {
+  for (int i = 0; i < 10; ++i) {
+    const __m256i two_p =
+        _mm256_set1_epi64x(i == 0 ? fe_avx2_2p0 : fe_avx2_2p[i & 1]);
+    h->v[i] = _mm256_sub_epi64(_mm256_add_epi64(f->v[i], two_p), g->v[i]);
+  }
+}
+
+// Carry the limbs h[0], ..., h[9] (each < 2^63) into a tight element.
+static inline LANES_TARGET void fe_avx2_carry_limbs(fe_avx2 *out, __m256i h[10]) {
+  __m256i c;
+  for (int i = 0; i < 9; ++i) {
+    c = _mm256_srli_epi64(h[i], fe_avx2_shift[i & 1]);
+    h[i] = _mm256_and_si256(h[i], _mm256_set1_epi64x(fe_avx2_mask[i & 1]));
+    h[i + 1] = _mm256_add_epi64(h[i + 1], c);
+  }
+  c = _mm256_srli_epi64(h[9], 25);
+  h[9] = _mm256_and_si256(h[9], _mm256_set1_epi64x(fe_avx2_mask[1]));
+  h[0] = _mm256_add_epi64(h[0], fe_avx2_times19(c));
+  c = _mm256_srli_epi64(h[0], 26);
+  h[0] = _mm256_and_si256(h[0], _mm256_set1_epi64x(fe_avx2_mask[0]));
+  h[1] = _mm256_add_epi64(h[1], c);
+  for (int i = 0; i < 10; ++i) {
+    out->v[i] = h[i];
+  }
+}
+
+static inline LANES_TARGET void fe_carry_avx2(fe_avx2 *h, const fe_avx2 *f) {
+  __m256i t[10];
+  for (int i = 0; i < 10; ++i) {
+    t[i] = f->v[i];
+  }
+  fe_avx2_carry_limbs(h, t);
+}
+
+// h = f * g
+//
+// The product of the limbs f[i] and g[j] has weight 2^(ceil(25.5 i) +
+// ceil(25.5 j)), i.e. it needs an extra factor 2 if both i and j are odd, and
+// a factor 19 if it wraps around (i + j >= 10), since 2^255 = 19 mod p.
+static inline LANES_TARGET void fe_mul_avx2(fe_avx2 *out, const fe_avx2 *f, const fe_avx2 *g) {
+  __m256i f2[10];
+  __m256i g19[10];
+  __m256i h[10];
+
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; ++i) {
+    f2[i] = _mm256_add_epi64(f->v[i], f->v[i]);
+    g19[i] = fe_avx2_times19(g->v[i]);
+    h[i] = _mm256_setzero_si256();
+  }
+
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; ++i) {
+#pragma GCC unroll 10
+    for (int j = 0; j < 10; ++j) {
+      const __m256i a = (i & j & 1) ? f2[i] : f->v[i];
+      const __m256i b = (i + j >= 10) ? g19[j] : g->v[j];
+      h[(i + j) % 10] = _mm256_add_epi64(h[(i + j) % 10], _mm256_mul_epu32(a, b));
+    }
+  }
+
+  fe_avx2_carry_limbs(out, h);
+}
+
+// h = f^2
+//
+// As above, but each product f[i] f[j] with i < j is only computed once and
+// doubled.
+static inline LANES_TARGET void fe_sq_avx2(fe_avx2 *out, const fe_avx2 *f) {
+  __m256i f2[10];
+  __m256i f4[10];
+  __m256i f19[10];
+  __m256i h[10];
+
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; ++i) {
+    f2[i] = _mm256_add_epi64(f->v[i], f->v[i]);
+    f4[i] = _mm256_add_epi64(f2[i], f2[i]);
+    f19[i] = fe_avx2_times19(f->v[i]);
+    h[i] = _mm256_setzero_si256();
+  }
+
+#pragma GCC unroll 10
+  for (int i = 0; i < 10; ++i) {
+#pragma GCC unroll 10
+    for (int j = i; j < 10; ++j) {
+      const int factor = (i < j ? 2 : 1) * ((i & j & 1) ? 2 : 1);
+      const __m256i a = factor == 4 ? f4[i] : (factor == 2 ? f2[i] : f->v[i]);
+      const __m256i b = (i + j >= 10) ? f19[j] : f->v[j];
+      h[(i + j) % 10] = _mm256_add_epi64(h[(i + j) % 10], _mm256_mul_epu32(a, b));
+    }
+  }
+
+  fe_avx2_carry_limbs(out, h);
+}
+
+// Replace h with f in all lanes where idx == j.
+static inline LANES_TARGET void fe_cmov_avx2(fe_avx2 *h, const fe_avx2 *f, idx_avx2 idx,
+                                unsigned j) {
+  const __m256i mask = _mm256_cmpeq_epi64(idx, _mm256_set1_epi64x(j));
+  for (int i = 0; i < 10; ++i) {
+    h->v[i] = _mm256_blendv_epi8(h->v[i], f->v[i], mask);
+  }
+}
+
+static inline LANES_TARGET idx_avx2 idx_load_avx2(const uint8_t idx[LANES]) {
+  return _mm256_setr_epi64x(idx[0], idx[1], idx[2], idx[3]);
+}
+
+// Load the tight elements in[0], ..., in[3] into the lanes of h.
+static inline LANES_TARGET void fe_load_avx2(fe_avx2 *h, const fe *const in[LANES]) {
+  for (int i = 0; i < 10; ++i) {
+    uint64_t limb[LANES];
+    for (int l = 0; l < LANES; ++l) {
+#if defined(BORINGSSL_CURVE25519_64BIT)
+      limb[l] = (i & 1) ? in[l]->v[i / 2] >> 26
+                        : in[l]->v[i / 2] & fe_avx2_mask[0];
+#else
+      limb[l] = in[l]->v[i];
+#endif
+    }
+    h->v[i] = _mm256_loadu_si256((const __m256i *)limb);
+  }
+}
+
+static inline LANES_TARGET void fe_broadcast_avx2(fe_avx2 *h, const fe *in) {
+  const fe *const in_lanes[LANES] = {in, in, in, in};
+  fe_load_avx2(h, in_lanes);
+}
+
+// Store the lanes of the tight element h into out[0], ..., out[3].
+static inline LANES_TARGET void fe_store_avx2(fe *const out[LANES], const fe_avx2 *h) {
+  uint64_t limb[10][LANES];
+  for (int i = 0; i < 10; ++i) {
+    _mm256_storeu_si256((__m256i *)limb[i], h->v[i]);
+  }
+  for (int l = 0; l < LANES; ++l) {
+#if defined(BORINGSSL_CURVE25519_64BIT)
+    for (int i = 0; i < 5; ++i) {
+      out[l]->v[i] = limb[2 * i][l] + (limb[2 * i + 1][l] << 26);
+    }
+#else
+    for (int i = 0; i < 10; ++i) {
+      out[l]->v[i] = (uint32_t)limb[i][l];
+    }
+#endif
+  }
+}
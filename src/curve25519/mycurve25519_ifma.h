@@ -0,0 +1,202 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// 8-way field arithmetic with AVX-512 IFMA.  Only to be included by
+// mycurve25519.c.  The functions carry their own target attribute, so this
+// does not require compiling with -mavx512ifma; callers have to check the CPU
+// features.
+//
+// Each 64-bit lane of a 512-bit vector holds one limb of an independent field
+// element.  The limbs use the radix 2^51 layout of the 64-bit code, i.e. an
+// element t[0], ..., t[4] represents t[0]+2^51 t[1]+...+2^204 t[4].  The
+// 52-bit multiply-accumulate instructions (vpmadd52luq/vpmadd52huq) ignore
+// the bits above 2^52 of their inputs, so all limbs are kept below 2^52:
+// add and sub already carry their results, and both tight and loose elements
+// have limbs < 2^51 + 2^6.
+
+#include <immintrin.h>
+
+#define LANES 8
+#define VN(name) name##_ifma
+#define LANES_TARGET __attribute__((target("avx512f,avx512bw,avx512ifma")))
+
+typedef struct { __m512i v[5]; } fe_ifma;
+typedef __m512i idx_ifma;
+
+#define FE_IFMA_MASK ((1ULL << 51) - 1)
+
+static inline LANES_TARGET __m512i fe_ifma_times19(__m512i x) {
+  return _mm512_add_epi64(
+      _mm512_add_epi64(_mm512_slli_epi64(x, 4), _mm512_slli_epi64(x, 1)), x);
+}
+
+static inline LANES_TARGET void fe_0_ifma(fe_ifma *h) {
+  for (int i = 0; i < 5; ++i) {
+    h->v[i] = _mm512_setzero_si512();
+  }
+}
+
+static inline LANES_TARGET void fe_1_ifma(fe_ifma *h) {
+  fe_0_ifma(h);
+  h->v[0] = _mm512_set1_epi64(1);
+}
+
+static inline LANES_TARGET void fe_copy_ifma(fe_ifma *h, const fe_ifma *f) {
+  *h = *f;
+}
+
+// One round of carries in parallel.  Limbs < 2^63 become < 2^51 + 19*2^12.
+static inline LANES_TARGET void fe_ifma_carry_round(__m512i h[5]) {
+  const __m512i mask = _mm512_set1_epi64(FE_IFMA_MASK);
+  __m512i c[5];
+  for (int i = 0; i < 5; ++i) {
+    c[i] = _mm512_srli_epi64(h[i], 51);
+    h[i] = _mm512_and_si512(h[i], mask);
+  }
+  h[0] = _mm512_add_epi64(h[0], fe_ifma_times19(c[4]));
+  for (int i = 1; i < 5; ++i) {
+    h[i] = _mm512_add_epi64(h[i], c[i - 1]);
+  }
+}
+
+static inline LANES_TARGET void fe_carry_ifma(fe_ifma *h, const fe_ifma *f) {
+  fe_copy_ifma(h, f);
+  fe_ifma_carry_round(h->v);
+}
+
+// h = f + g
+static inline LANES_TARGET void fe_add_ifma(fe_ifma *h, const fe_ifma *f, const fe_ifma *g) {
+  for (int i = 0; i < 5; ++i) {
+    h->v[i] = _mm512_add_epi64(f->v[i], g->v[i]);
+  }
+  fe_ifma_carry_round(h->v);
+}
+
+// h = f + 2p - g
+static inline LANES_TARGET void fe_sub_ifma(fe_ifma *h, const fe_ifma *f, const fe_ifma *g) {
+  for (int i = 0; i < 5; ++i) {
+    const __m512i two_p =
+        _mm512_set1_epi64(i == 0 ? 0xfffffffffffdaULL : 0xffffffffffffeULL);
+    h->v[i] = _mm512_sub_epi64(_mm512_add_epi64(f->v[i], two_p), g->v[i]);
+  }
+  fe_ifma_carry_round(h->v);
+}
+
+// h = f * g
+//
+// The 104-bit product of the limbs f[i] and g[j] is split into its low 52
+// bits, which have weight 2^(51 (i + j)), and its high part with weight
+// 2^(51 (i + j) + 52) = 2 * 2^(51 (i + j + 1)).  Positions >= 5 wrap around
+// with a factor 19, since 2^255 = 19 mod p.
+static inline LANES_TARGET void fe_mul_ifma(fe_ifma *out, const fe_ifma *f, const fe_ifma *g) {
+  __m512i lo[10];
+  __m512i hi[10];
+
+#pragma GCC unroll 10
+  for (int k = 0; k < 10; ++k) {
+    lo[k] = _mm512_setzero_si512();
+    hi[k] = _mm512_setzero_si512();
+  }
+
+#pragma GCC unroll 5
+  for (int i = 0; i < 5; ++i) {
+#pragma GCC unroll 5
+    for (int j = 0; j < 5; ++j) {
+      lo[i + j] = _mm512_madd52lo_epu64(lo[i + j], f->v[i], g->v[j]);
+      hi[i + j + 1] = _mm512_madd52hi_epu64(hi[i + j + 1], f->v[i], g->v[j]);
+    }
+  }
+
+  __m512i h[5];
+#pragma GCC unroll 5
+  for (int k = 0; k < 5; ++k) {
+    const __m512i low = _mm512_add_epi64(lo[k], _mm512_slli_epi64(hi[k], 1));
+    const __m512i high =
+        _mm512_add_epi64(lo[k + 5], _mm512_slli_epi64(hi[k + 5], 1));
+    h[k] = _mm512_add_epi64(low, fe_ifma_times19(high));
+  }
+
+  fe_ifma_carry_round(h);
+  fe_ifma_carry_round(h);
+  for (int i = 0; i < 5; ++i) {
+    out->v[i] = h[i];
+  }
+}
+
+// h = f^2
+static inline LANES_TARGET void fe_sq_ifma(fe_ifma *h, const fe_ifma *f) {
+  fe_mul_ifma(h, f, f);
+}
+
+// Replace h with f in all lanes where idx == j.
+static inline LANES_TARGET void fe_cmov_ifma(fe_ifma *h, const fe_ifma *f, idx_ifma idx,
+                                unsigned j) {
+  const __mmask8 mask = _mm512_cmpeq_epi64_mask(idx, _mm512_set1_epi64(j));
+  for (int i = 0; i < 5; ++i) {
+    h->v[i] = _mm512_mask_mov_epi64(h->v[i], mask, f->v[i]);
+  }
+}
+
+static inline LANES_TARGET idx_ifma idx_load_ifma(const uint8_t idx[LANES]) {
+  return _mm512_setr_epi64(idx[0], idx[1], idx[2], idx[3],
+                           idx[4], idx[5], idx[6], idx[7]);
+}
+
+// Load the tight elements in[0], ..., in[7] into the lanes of h.
+static inline LANES_TARGET void fe_load_ifma(fe_ifma *h, const fe *const in[LANES]) {
+  for (int i = 0; i < 5; ++i) {
+    uint64_t limb[LANES];
+    for (int l = 0; l < LANES; ++l) {
+#if defined(BORINGSSL_CURVE25519_64BIT)
+      limb[l] = in[l]->v[i];
+#else
+      limb[l] = in[l]->v[2 * i] + ((uint64_t)in[l]->v[2 * i + 1] << 26);
+#endif
+    }
+    h->v[i] = _mm512_loadu_si512(limb);
+  }
+}
+
+static inline LANES_TARGET void fe_broadcast_ifma(fe_ifma *h, const fe *in) {
+  const fe *const in_lanes[LANES] = {in, in, in, in, in, in, in, in};
+  fe_load_ifma(h, in_lanes);
+}
+
+// Store the lanes of the tight element h into out[0], ..., out[7].
+static inline LANES_TARGET void fe_store_ifma(fe *const out[LANES], const fe_ifma *h) {
+  uint64_t limb[5][LANES];
+  for (int i = 0; i < 5; ++i) {
+    _mm512_storeu_si512(limb[i], h->v[i]);
+  }
+  for (int l = 0; l < LANES; ++l) {
+#if defined(BORINGSSL_CURVE25519_64BIT)
+    for (int i = 0; i < 5; ++i) {
+      out[l]->v[i] = limb[i][l];
+    }
+#else
+    for (int i = 0; i < 5; ++i) {
+      out[l]->v[2 * i] = limb[i][l] & ((1 << 26) - 1);
+      out[l]->v[2 * i + 1] = limb[i][l] >> 26;
+    }
+#endif
+  }
+}
@@ -0,0 +1,405 @@
+// The MIT License (MIT)
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Lane-parallel group operations and scalar multiplications on top of one of
+// the vectorized field backends.  Only to be included by mycurve25519.c, after
+// a backend has defined LANES, VN(), LANES_TARGET and the VN(fe_*) functions.
+//
+// The functions mirror their scalar counterparts in mycurve25519.c and
+// compute LANES independent results at once.
+
+typedef struct {
+  VN(fe) X;
+  VN(fe) Y;
+  VN(fe) Z;
+} VN(ge_p2);
+
+typedef struct {
+  VN(fe) X;
+  VN(fe) Y;
+  VN(fe) Z;
+  VN(fe) T;
+} VN(ge_p3);
+
+typedef struct {
+  VN(fe) X;
+  VN(fe) Y;
+  VN(fe) Z;
+  VN(fe) T;
+} VN(ge_p1p1);
+
+typedef struct {
+  VN(fe) yplusx;
+  VN(fe) yminusx;
+  VN(fe) xy2d;
+} VN(ge_precomp);
+
+typedef struct {
+  VN(fe) YplusX;
+  VN(fe) YminusX;
+  VN(fe) Z;
+  VN(fe) T2d;
+} VN(ge_cached);
+
+static inline LANES_TARGET void VN(ge_p2_0)(VN(ge_p2) *h) {
+  VN(fe_0)(&h->X);
+  VN(fe_1)(&h->Y);
+  VN(fe_1)(&h->Z);
+}
+
+static inline LANES_TARGET void VN(ge_p3_0)(VN(ge_p3) *h) {
+  VN(fe_0)(&h->X);
+  VN(fe_1)(&h->Y);
+  VN(fe_1)(&h->Z);
+  VN(fe_0)(&h->T);
+}
+
+static inline LANES_TARGET void VN(ge_cached_0)(VN(ge_cached) *h) {
+  VN(fe_1)(&h->YplusX);
+  VN(fe_1)(&h->YminusX);
+  VN(fe_1)(&h->Z);
+  VN(fe_0)(&h->T2d);
+}
+
+// r = p
+static inline LANES_TARGET void VN(ge_p3_to_p2)(VN(ge_p2) *r, const VN(ge_p3) *p) {
+  VN(fe_copy)(&r->X, &p->X);
+  VN(fe_copy)(&r->Y, &p->Y);
+  VN(fe_copy)(&r->Z, &p->Z);
+}
+
+// r = p
+static inline LANES_TARGET void VN(ge_p3_to_cached)(VN(ge_cached) *r, const VN(ge_p3) *p,
+                                       const VN(fe) *d2v) {
+  VN(fe_add)(&r->YplusX, &p->Y, &p->X);
+  VN(fe_sub)(&r->YminusX, &p->Y, &p->X);
+  VN(fe_copy)(&r->Z, &p->Z);
+  VN(fe_mul)(&r->T2d, &p->T, d2v);
+}
+
+// r = p
+static inline LANES_TARGET void VN(ge_p1p1_to_p2)(VN(ge_p2) *r, const VN(ge_p1p1) *p) {
+  VN(fe_mul)(&r->X, &p->X, &p->T);
+  VN(fe_mul)(&r->Y, &p->Y, &p->Z);
+  VN(fe_mul)(&r->Z, &p->Z, &p->T);
+}
+
+// r = p
+static inline LANES_TARGET void VN(ge_p1p1_to_p3)(VN(ge_p3) *r, const VN(ge_p1p1) *p) {
+  VN(fe_mul)(&r->X, &p->X, &p->T);
+  VN(fe_mul)(&r->Y, &p->Y, &p->Z);
+  VN(fe_mul)(&r->Z, &p->Z, &p->T);
+  VN(fe_mul)(&r->T, &p->X, &p->Y);
+}
+
+// r = p
+static inline LANES_TARGET void VN(ge_p1p1_to_cached)(VN(ge_cached) *r,
+                                         const VN(ge_p1p1) *p,
+                                         const VN(fe) *d2v) {
+  VN(ge_p3) t;
+  VN(ge_p1p1_to_p3)(&t, p);
+  VN(ge_p3_to_cached)(r, &t, d2v);
+}
+
+// r = 2 * p
+static inline LANES_TARGET void VN(ge_p2_dbl)(VN(ge_p1p1) *r, const VN(ge_p2) *p) {
+  VN(fe) trX, trZ, trT;
+  VN(fe) t0;
+
+  VN(fe_sq)(&trX, &p->X);
+  VN(fe_sq)(&trZ, &p->Y);
+  VN(fe_sq)(&trT, &p->Z);
+  VN(fe_add)(&t0, &trT, &trT);
+  VN(fe_carry)(&trT, &t0);
+  VN(fe_add)(&r->Y, &p->X, &p->Y);
+  VN(fe_sq)(&t0, &r->Y);
+
+  VN(fe_add)(&r->Y, &trZ, &trX);
+  VN(fe_sub)(&r->Z, &trZ, &trX);
+  VN(fe_carry)(&trZ, &r->Y);
+  VN(fe_sub)(&r->X, &t0, &trZ);
+  VN(fe_carry)(&trZ, &r->Z);
+  VN(fe_sub)(&r->T, &trT, &trZ);
+}
+
+// r = 2 * p
+static inline LANES_TARGET void VN(ge_p3_dbl)(VN(ge_p1p1) *r, const VN(ge_p3) *p) {
+  VN(ge_p2) q;
+  VN(ge_p3_to_p2)(&q, p);
+  VN(ge_p2_dbl)(r, &q);
+}
+
+// r = p + q
+static inline LANES_TARGET void VN(ge_madd)(VN(ge_p1p1) *r, const VN(ge_p3) *p,
+                               const VN(ge_precomp) *q) {
+  VN(fe) trY, trZ, trT;
+
+  VN(fe_add)(&r->X, &p->Y, &p->X);
+  VN(fe_sub)(&r->Y, &p->Y, &p->X);
+  VN(fe_mul)(&trZ, &r->X, &q->yplusx);
+  VN(fe_mul)(&trY, &r->Y, &q->yminusx);
+  VN(fe_mul)(&trT, &q->xy2d, &p->T);
+  VN(fe_add)(&r->T, &p->Z, &p->Z);
+  VN(fe_sub)(&r->X, &trZ, &trY);
+  VN(fe_add)(&r->Y, &trZ, &trY);
+  VN(fe_carry)(&trZ, &r->T);
+  VN(fe_add)(&r->Z, &trZ, &trT);
+  VN(fe_sub)(&r->T, &trZ, &trT);
+}
+
+// r = p + q
+static inline LANES_TARGET void VN(ge_add)(VN(ge_p1p1) *r, const VN(ge_p3) *p,
+                              const VN(ge_cached) *q) {
+  VN(fe) trX, trY, trZ, trT;
+
+  VN(fe_add)(&r->X, &p->Y, &p->X);
+  VN(fe_sub)(&r->Y, &p->Y, &p->X);
+  VN(fe_mul)(&trZ, &r->X, &q->YplusX);
+  VN(fe_mul)(&trY, &r->Y, &q->YminusX);
+  VN(fe_mul)(&trT, &q->T2d, &p->T);
+  VN(fe_mul)(&trX, &p->Z, &q->Z);
+  VN(fe_add)(&r->T, &trX, &trX);
+  VN(fe_sub)(&r->X, &trZ, &trY);
+  VN(fe_add)(&r->Y, &trZ, &trY);
+  VN(fe_carry)(&trZ, &r->T);
+  VN(fe_add)(&r->Z, &trZ, &trT);
+  VN(fe_sub)(&r->T, &trZ, &trT);
+}
+
+static inline LANES_TARGET void VN(ge_cached_cmov)(VN(ge_cached) *t, const VN(ge_cached) *u,
+                                      VN(idx) idx, unsigned j) {
+  VN(fe_cmov)(&t->YplusX, &u->YplusX, idx, j);
+  VN(fe_cmov)(&t->YminusX, &u->YminusX, idx, j);
+  VN(fe_cmov)(&t->Z, &u->Z, idx, j);
+  VN(fe_cmov)(&t->T2d, &u->T2d, idx, j);
+}
+
+static inline LANES_TARGET void VN(ge_p3_load)(VN(ge_p3) *h, const ge_p3 *in) {
+  const fe *X[LANES], *Y[LANES], *Z[LANES], *T[LANES];
+  for (int l = 0; l < LANES; ++l) {
+    X[l] = &in[l].X;
+    Y[l] = &in[l].Y;
+    Z[l] = &in[l].Z;
+    T[l] = &in[l].T;
+  }
+  VN(fe_load)(&h->X, X);
+  VN(fe_load)(&h->Y, Y);
+  VN(fe_load)(&h->Z, Z);
+  VN(fe_load)(&h->T, T);
+}
+
+static inline LANES_TARGET void VN(ge_p3_store)(ge_p3 *out, const VN(ge_p3) *h) {
+  fe *X[LANES], *Y[LANES], *Z[LANES], *T[LANES];
+  for (int l = 0; l < LANES; ++l) {
+    X[l] = &out[l].X;
+    Y[l] = &out[l].Y;
+    Z[l] = &out[l].Z;
+    T[l] = &out[l].T;
+  }
+  VN(fe_store)(X, &h->X);
+  VN(fe_store)(Y, &h->Y);
+  VN(fe_store)(Z, &h->Z);
+  VN(fe_store)(T, &h->T);
+}
+
+static inline LANES_TARGET void VN(ge_p2_store)(ge_p2 *out, const VN(ge_p2) *h) {
+  fe *X[LANES], *Y[LANES], *Z[LANES];
+  for (int l = 0; l < LANES; ++l) {
+    X[l] = &out[l].X;
+    Y[l] = &out[l].Y;
+    Z[l] = &out[l].Z;
+  }
+  VN(fe_store)(X, &h->X);
+  VN(fe_store)(Y, &h->Y);
+  VN(fe_store)(Z, &h->Z);
+}
+
+#if !defined(OPENSSL_SMALL)
+
+static inline LANES_TARGET void VN(ge_precomp_cmov)(VN(ge_precomp) *t,
+                                                    const VN(ge_precomp) *u,
+                                                    VN(idx) idx, unsigned j) {
+  VN(fe_cmov)(&t->yplusx, &u->yplusx, idx, j);
+  VN(fe_cmov)(&t->yminusx, &u->yminusx, idx, j);
+  VN(fe_cmov)(&t->xy2d, &u->xy2d, idx, j);
+}
+
+// Lane-parallel version of table_select: lane l of t is set to
+// b[l] * 16^(2 pos) * B.
+static inline LANES_TARGET void VN(table_select)(VN(ge_precomp) *t, int pos,
+                                                 const signed char *b) {
+  uint8_t babs[LANES], bnegative[LANES];
+  VN(ge_precomp) u;
+  VN(fe) zero;
+  int l;
+  unsigned j;
+
+  for (l = 0; l < LANES; ++l) {
+    bnegative[l] = negative(b[l]);
+    babs[l] = b[l] - ((uint8_t)((-bnegative[l]) & b[l]) << 1);
+  }
+  const VN(idx) idx_abs = VN(idx_load)(babs);
+  const VN(idx) idx_negative = VN(idx_load)(bnegative);
+
+  VN(fe_1)(&t->yplusx);
+  VN(fe_1)(&t->yminusx);
+  VN(fe_0)(&t->xy2d);
+  for (j = 0; j < 8; ++j) {
+    // NOTE: the input table is canonical, but types don't encode it
+    const ge_precomp *entry = &k25519Precomp[pos][j];
+    VN(fe_broadcast)(&u.yplusx, (const fe *)&entry->yplusx);
+    VN(fe_broadcast)(&u.yminusx, (const fe *)&entry->yminusx);
+    VN(fe_broadcast)(&u.xy2d, (const fe *)&entry->xy2d);
+    VN(ge_precomp_cmov)(t, &u, idx_abs, j + 1);
+  }
+
+  VN(fe_copy)(&u.yplusx, &t->yminusx);
+  VN(fe_copy)(&u.yminusx, &t->yplusx);
+  VN(fe_0)(&zero);
+  VN(fe_sub)(&u.xy2d, &zero, &t->xy2d);
+  VN(fe_carry)(&u.xy2d, &u.xy2d);
+  VN(ge_precomp_cmov)(t, &u, idx_negative, 1);
+}
+
+// h[l] = a[l] * B for l < LANES, where a[l] is given by the 32 bytes at
+// a + 32 * l.  See x25519_ge_scalarmult_base.
+static LANES_TARGET void VN(ge_scalarmult_base)(ge_p3 *h, const uint8_t *a) {
+  signed char e[64][LANES];
+  signed char carry;
+  VN(ge_p3) hv;
+  VN(ge_p1p1) r;
+  VN(ge_p2) s;
+  VN(ge_precomp) tv;
+  int i, l;
+
+  for (l = 0; l < LANES; ++l) {
+    const uint8_t *al = a + 32 * l;
+    for (i = 0; i < 32; ++i) {
+      e[2 * i + 0][l] = (al[i] >> 0) & 15;
+      e[2 * i + 1][l] = (al[i] >> 4) & 15;
+    }
+    carry = 0;
+    for (i = 0; i < 63; ++i) {
+      e[i][l] += carry;
+      carry = e[i][l] + 8;
+      carry >>= 4;
+      e[i][l] -= carry << 4;
+    }
+    e[63][l] += carry;
+  }
+
+  VN(ge_p3_0)(&hv);
+  for (i = 1; i < 64; i += 2) {
+    VN(table_select)(&tv, i / 2, e[i]);
+    VN(ge_madd)(&r, &hv, &tv);
+    VN(ge_p1p1_to_p3)(&hv, &r);
+  }
+
+  VN(ge_p3_dbl)(&r, &hv);
+  VN(ge_p1p1_to_p2)(&s, &r);
+  VN(ge_p2_dbl)(&r, &s);
+  VN(ge_p1p1_to_p2)(&s, &r);
+  VN(ge_p2_dbl)(&r, &s);
+  VN(ge_p1p1_to_p2)(&s, &r);
+  VN(ge_p2_dbl)(&r, &s);
+  VN(ge_p1p1_to_p3)(&hv, &r);
+
+  for (i = 0; i < 64; i += 2) {
+    VN(table_select)(&tv, i / 2, e[i]);
+    VN(ge_madd)(&r, &hv, &tv);
+    VN(ge_p1p1_to_p3)(&hv, &r);
+  }
+
+  VN(ge_p3_store)(h, &hv);
+}
+
+#endif  // !defined(OPENSSL_SMALL)
+
+// r[l] = scalar[l] * A[l] for l < LANES, where scalar[l] is given by the 32
+// bytes at scalar + 32 * l.  See x25519_ge_scalarmult.
+static LANES_TARGET void VN(ge_scalarmult)(ge_p2 *r, const uint8_t *scalar, const ge_p3 *A) {
+  VN(fe) d2v;
+  VN(ge_p3) Av;
+  VN(ge_p2) Ai_p2[8];
+  VN(ge_cached) Ai[16];
+  VN(ge_p1p1) t;
+  VN(ge_p2) rv;
+  VN(ge_p3) u;
+  VN(ge_cached) selected;
+  uint8_t index[LANES];
+  unsigned i, j;
+  int l;
+
+  VN(fe_broadcast)(&d2v, &d2);
+  VN(ge_p3_load)(&Av, A);
+
+  VN(ge_cached_0)(&Ai[0]);
+  VN(ge_p3_to_cached)(&Ai[1], &Av, &d2v);
+  VN(ge_p3_to_p2)(&Ai_p2[1], &Av);
+
+  for (i = 2; i < 16; i += 2) {
+    VN(ge_p2_dbl)(&t, &Ai_p2[i / 2]);
+    VN(ge_p1p1_to_cached)(&Ai[i], &t, &d2v);
+    if (i < 8) {
+      VN(ge_p1p1_to_p2)(&Ai_p2[i], &t);
+    }
+    VN(ge_add)(&t, &Av, &Ai[i]);
+    VN(ge_p1p1_to_cached)(&Ai[i + 1], &t, &d2v);
+    if (i < 7) {
+      VN(ge_p1p1_to_p2)(&Ai_p2[i + 1], &t);
+    }
+  }
+
+  VN(ge_p2_0)(&rv);
+
+  for (i = 0; i < 256; i += 4) {
+    VN(ge_p2_dbl)(&t, &rv);
+    VN(ge_p1p1_to_p2)(&rv, &t);
+    VN(ge_p2_dbl)(&t, &rv);
+    VN(ge_p1p1_to_p2)(&rv, &t);
+    VN(ge_p2_dbl)(&t, &rv);
+    VN(ge_p1p1_to_p2)(&rv, &t);
+    VN(ge_p2_dbl)(&t, &rv);
+    VN(ge_p1p1_to_p3)(&u, &t);
+
+    for (l = 0; l < LANES; ++l) {
+      index[l] = scalar[32 * l + 31 - i / 8];
+      index[l] >>= 4 - (i & 4);
+      index[l] &= 0xf;
+    }
+    const VN(idx) idx = VN(idx_load)(index);
+
+    VN(ge_cached_0)(&selected);
+    for (j = 0; j < 16; j++) {
+      VN(ge_cached_cmov)(&selected, &Ai[j], idx, j);
+    }
+
+    VN(ge_add)(&t, &u, &selected);
+    VN(ge_p1p1_to_p2)(&rv, &t);
+  }
+
+  VN(ge_p2_store)(r, &rv);
+}
+
+#undef LANES
+#undef VN
+#undef LANES_TARGET
@@ -22,28 +22,183 @@
 
 #include "util.h"
 
-#include "stdio.h"
-#include "stdlib.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/random.h>
 
-void random_bytes(void* buf, size_t nbytes)
+// Thread-local random number generator: ChaCha20 keyed once per thread with
+// 32 bytes from getrandom(), producing RANDOM_BUFFER_SIZE bytes of keystream
+// per refill.  After each refill the first 32 bytes of the keystream replace
+// the key and are erased from the buffer ("fast key erasure"), so a later
+// compromise of the state does not reveal earlier outputs.  Bytes are wiped
+// from the buffer as soon as they are handed out.
+
+#define RANDOM_BLOCKS 64
+#define RANDOM_BUFFER_SIZE (RANDOM_BLOCKS * 64)
+
+typedef struct
+{
+    uint32_t key[8];
+    uint8_t buffer[RANDOM_BUFFER_SIZE];
+    size_t pos;
+    // fork generation this state belongs to, 0 if not yet seeded
+    unsigned generation;
+} random_state;
+
+static _Thread_local random_state rng;
+
+// Incremented in the child after fork(), so that parent and child do not
+// continue with the same state.
+static volatile unsigned random_generation = 1;
+static pthread_once_t random_atfork_once = PTHREAD_ONCE_INIT;
+
+static void random_atfork_child(void) { ++random_generation; }
+
+static void random_register_atfork(void)
+{
+    pthread_atfork(NULL, NULL, random_atfork_child);
+}
+
+static inline uint32_t rotl32(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+static inline uint32_t load32_le(const uint8_t* in)
 {
-    FILE* f = fopen("/dev/urandom", "r");
-    if (f == NULL)
+    return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16) |
+           ((uint32_t)in[3] << 24);
+}
+
+static inline void store32_le(uint8_t* out, uint32_t v)
+{
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+#define QUARTERROUND(a, b, c, d) \
+    a += b; d = rotl32(d ^ a, 16); \
+    c += d; b = rotl32(b ^ c, 12); \
+    a += b; d = rotl32(d ^ a, 8);  \
+    c += d; b = rotl32(b ^ c, 7);
+
+// One 64 byte block of ChaCha20 keystream with the given key, block counter
+// and an all-zero nonce.
+static void chacha20_block(uint8_t out[64], const uint32_t key[8],
+                           uint64_t counter)
+{
+    uint32_t in[16] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+    memcpy(&in[4], key, 32);
+    in[12] = (uint32_t)counter;
+    in[13] = (uint32_t)(counter >> 32);
+    in[14] = 0;
+    in[15] = 0;
+
+    uint32_t x[16];
+    memcpy(x, in, sizeof(x));
+    for (int i = 0; i < 10; ++i)
+    {
+        QUARTERROUND(x[0], x[4], x[8], x[12])
+        QUARTERROUND(x[1], x[5], x[9], x[13])
+        QUARTERROUND(x[2], x[6], x[10], x[14])
+        QUARTERROUND(x[3], x[7], x[11], x[15])
+        QUARTERROUND(x[0], x[5], x[10], x[15])
+        QUARTERROUND(x[1], x[6], x[11], x[12])
+        QUARTERROUND(x[2], x[7], x[8], x[13])
+        QUARTERROUND(x[3], x[4], x[9], x[14])
+    }
+    for (int i = 0; i < 16; ++i)
     {
-        perror("fopen(\"/dev/urandom\", \"r\")");
-        exit(1);
+        store32_le(out + 4 * i, x[i] + in[i]);
     }
+}
+
+#undef QUARTERROUND
+
+static void random_set_key(const uint8_t seed[32])
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        rng.key[i] = load32_le(seed + 4 * i);
+    }
+    // the buffer is empty
+    rng.pos = RANDOM_BUFFER_SIZE;
+    rng.generation = random_generation;
+}
+
+static void random_refill(void)
+{
+    for (uint64_t i = 0; i < RANDOM_BLOCKS; ++i)
+    {
+        chacha20_block(rng.buffer + 64 * i, rng.key, i);
+    }
+    random_set_key(rng.buffer);
+    memset(rng.buffer, 0, 32);
+    rng.pos = 32;
+}
+
+static void os_random_bytes(uint8_t* buf, size_t nbytes)
+{
     size_t read = 0;
     while (read < nbytes)
     {
-        size_t ret = fread((unsigned char*)buf + read, 1, nbytes - read, f);
-        if (ret == 0)
+        ssize_t ret = getrandom(buf + read, nbytes - read, 0);
+        if (ret < 0)
         {
-            fprintf(stderr, "fread from /dev/urandom failed");
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            perror("getrandom");
             exit(1);
         }
-        read += ret;
+        read += (size_t)ret;
     }
+}
+
+void random_reseed(void)
+{
+    uint8_t seed[32];
+    pthread_once(&random_atfork_once, random_register_atfork);
+    os_random_bytes(seed, sizeof(seed));
+    random_set_key(seed);
+    memset(seed, 0, sizeof(seed));
+}
 
-    fclose(f);
+void random_seed(const uint8_t seed[32])
+{
+    pthread_once(&random_atfork_once, random_register_atfork);
+    random_set_key(seed);
+}
+
+void random_bytes(void* buf, size_t nbytes)
+{
+    uint8_t* out = (uint8_t*)buf;
+    if (rng.generation != random_generation)
+    {
+        random_reseed();
+    }
+    while (nbytes > 0)
+    {
+        if (rng.pos == RANDOM_BUFFER_SIZE)
+        {
+            random_refill();
+        }
+        size_t n = RANDOM_BUFFER_SIZE - rng.pos;
+        if (n > nbytes)
+        {
+            n = nbytes;
+        }
+        memcpy(out, rng.buffer + rng.pos, n);
+        memset(rng.buffer + rng.pos, 0, n);
+        rng.pos += n;
+        out += n;
+        nbytes -= n;
+    }
 }
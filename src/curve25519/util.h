@@ -28,9 +28,20 @@ extern "C" {
 #endif
 
 #include <stddef.h>
+#include <stdint.h>
 
+// Fill buf with nbytes random bytes from the calling thread's generator.  The
+// generator is seeded from the operating system on first use in each thread
+// (and again in the child after fork()).
 void random_bytes(void* buf, size_t nbytes);
 
+// Deterministically seed the calling thread's generator, e.g. for tests.  The
+// output of random_bytes is then a fixed function of the seed.
+void random_seed(const uint8_t seed[32]);
+
+// Reseed the calling thread's generator from the operating system.
+void random_reseed(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
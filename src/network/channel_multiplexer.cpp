@@ -0,0 +1,280 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include "channel_multiplexer.hpp"
+
+/**
+ * Endpoint of a logical channel.  Received payloads are queued until they
+ * are read.
+ */
+class ChannelMultiplexer::Channel : public Connection
+{
+public:
+    Channel(ChannelMultiplexer& multiplexer, uint32_t id)
+        : multiplexer_(multiplexer), id_(id), mutex_(), cv_(), queue_(), offset_(0), closed_(false), error_(),
+          send_credit_(multiplexer.window_size_), bytes_read_(0)
+    {
+    }
+
+    void send_message(const uint8_t* buffer, size_t length) override
+    {
+        uint64_t header = length;
+        send_v({{reinterpret_cast<const uint8_t*>(&header), sizeof(header)}, {buffer, length}});
+    }
+
+    bytes_t recv_message() override
+    {
+        uint64_t length;
+        recv(reinterpret_cast<uint8_t*>(&length), sizeof(length));
+        bytes_t buffer(length);
+        recv(buffer.data(), length);
+        return buffer;
+    }
+
+    void send(const uint8_t* buffer, size_t length) override
+    {
+        while (length > 0)
+        {
+            size_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return send_credit_ > 0 || closed_; });
+                if (send_credit_ == 0)
+                    throw_closed();
+                n = std::min({length, max_frame_size, send_credit_});
+                send_credit_ -= n;
+            }
+            multiplexer_.send_frame(id_, buffer, n);
+            buffer += n;
+            length -= n;
+        }
+    }
+
+    void recv(uint8_t* buffer, size_t length) override
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (length > 0)
+        {
+            // a single recv may be longer than the window
+            return_credit(lock);
+            cv_.wait(lock, [this] { return !queue_.empty() || closed_; });
+            if (queue_.empty())
+                throw_closed();
+            auto& front = queue_.front();
+            auto n = std::min(length, front.size() - offset_);
+            std::memcpy(buffer, front.data() + offset_, n);
+            buffer += n;
+            length -= n;
+            offset_ += n;
+            bytes_read_ += n;
+            if (offset_ == front.size())
+            {
+                queue_.pop_front();
+                offset_ = 0;
+            }
+        }
+        // the sender may wait for this credit before we call recv again
+        return_credit(lock);
+    }
+
+    /**
+     * Called by the reading thread.
+     */
+    void deliver(bytes_t&& payload)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(payload));
+        cv_.notify_all();
+    }
+
+    void add_credit(size_t credit)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        send_credit_ += credit;
+        cv_.notify_all();
+    }
+
+    void close(std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        error_ = error;
+        cv_.notify_all();
+    }
+
+private:
+    /**
+     * Return the credit for the read bytes once they amount to half a
+     * window.  Then a blocked sender has more than half a window queued here
+     * which is not read yet.
+     */
+    void return_credit(std::unique_lock<std::mutex>& lock)
+    {
+        if (bytes_read_ < multiplexer_.window_size_ / 2)
+            return;
+        auto credit = bytes_read_;
+        bytes_read_ = 0;
+        lock.unlock();
+        multiplexer_.send_credit(id_, credit);
+        lock.lock();
+    }
+
+    [[noreturn]] void throw_closed()
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+        throw std::runtime_error("channel closed by the other party");
+    }
+
+    ChannelMultiplexer& multiplexer_;
+    const uint32_t id_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<bytes_t> queue_;
+    // number of bytes already read from the front of the queue
+    size_t offset_;
+    bool closed_;
+    std::exception_ptr error_;
+    // bytes we may send before the other party returns credit
+    size_t send_credit_;
+    // bytes read for which no credit was returned yet
+    size_t bytes_read_;
+};
+
+
+ChannelMultiplexer::ChannelMultiplexer(Connection& connection, size_t window_size)
+    : connection_(connection), window_size_(window_size), send_mutex_(), close_sent_(false), channels_mutex_(), channels_(),
+      reader_done_(false), reader_error_(), reader_()
+{
+    if (window_size == 0 || window_size >= credit_flag)
+        throw std::invalid_argument("invalid window size");
+    reader_ = std::thread([this] { read_loop(); });
+}
+
+ChannelMultiplexer::~ChannelMultiplexer()
+{
+    try
+    {
+        send_close();
+    }
+    catch (...)
+    {
+        // the reader fails as well if the connection is broken
+    }
+    reader_.join();
+}
+
+Conn_p ChannelMultiplexer::channel(uint32_t id)
+{
+    if (id == close_id)
+        throw std::out_of_range("reserved channel id");
+    return get_channel(id);
+}
+
+std::shared_ptr<ChannelMultiplexer::Channel> ChannelMultiplexer::get_channel(uint32_t id)
+{
+    std::lock_guard<std::mutex> lock(channels_mutex_);
+    auto& channel = channels_[id];
+    if (!channel)
+    {
+        channel = std::make_shared<Channel>(*this, id);
+        if (reader_done_)
+            channel->close(reader_error_);
+    }
+    return channel;
+}
+
+void ChannelMultiplexer::send_frame(uint32_t id, const uint8_t* buffer, size_t length)
+{
+    uint32_t header[2] = {htonl(id), htonl(static_cast<uint32_t>(length))};
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (close_sent_)
+        throw std::logic_error("multiplexer is closed");
+    connection_.send_v({{reinterpret_cast<const uint8_t*>(header), sizeof(header)}, {buffer, length}});
+}
+
+void ChannelMultiplexer::send_credit(uint32_t id, size_t credit)
+{
+    uint32_t header[2] = {htonl(id), htonl(credit_flag | static_cast<uint32_t>(credit))};
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    // the other party does not send anymore
+    if (close_sent_)
+        return;
+    connection_.send(reinterpret_cast<const uint8_t*>(header), sizeof(header));
+}
+
+void ChannelMultiplexer::send_close()
+{
+    uint32_t header[2] = {htonl(close_id), 0};
+    std::lock_guard<std::mutex> lock(send_mutex_);
+    if (close_sent_)
+        return;
+    close_sent_ = true;
+    connection_.send(reinterpret_cast<const uint8_t*>(header), sizeof(header));
+}
+
+void ChannelMultiplexer::read_loop()
+{
+    std::exception_ptr error;
+    try
+    {
+        while (true)
+        {
+            uint32_t header[2];
+            connection_.recv(reinterpret_cast<uint8_t*>(header), sizeof(header));
+            auto id = ntohl(header[0]);
+            auto length = ntohl(header[1]);
+            if (id == close_id)
+            {
+                // the other party may be waiting for our close
+                send_close();
+                break;
+            }
+            if (length & credit_flag)
+            {
+                get_channel(id)->add_credit(length & ~credit_flag);
+                continue;
+            }
+            bytes_t payload(length);
+            connection_.recv(payload.data(), length);
+            get_channel(id)->deliver(std::move(payload));
+        }
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    std::lock_guard<std::mutex> lock(channels_mutex_);
+    reader_done_ = true;
+    reader_error_ = error;
+    for (auto& entry : channels_)
+    {
+        entry.second->close(error);
+    }
+}
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CHANNEL_MULTIPLEXER_HPP
+#define CHANNEL_MULTIPLEXER_HPP
+
+#include <exception>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "connection.hpp"
+
+/**
+ * Multiplexes numbered logical channels over a single connection.
+ *
+ * Data sent on a channel is split into frames of at most max_frame_size
+ * bytes, each prefixed with the channel id and its length, so that frames of
+ * different channels are interleaved on the underlying connection.  A
+ * background thread reads the frames and queues the payloads for the
+ * respective channel.  A channel is a Connection with stream semantics, i.e.
+ * recv can read any length.  Both parties need to use the same channel ids
+ * and window size, and each channel is used by one sending and one receiving
+ * thread.
+ *
+ * Each channel has its own flow control: a sender may have at most
+ * window_size bytes outstanding that the receiving side has not read yet,
+ * otherwise send blocks.  The receiving side returns credit for the bytes it
+ * has read in separate frames.  Hence, the queued data per channel is
+ * bounded, and a channel that is not read only stalls its own sender.
+ *
+ * The multiplexer owns the reading side of the underlying connection, which
+ * must not be used directly while it exists.
+ */
+class ChannelMultiplexer
+{
+public:
+    explicit ChannelMultiplexer(Connection& connection, size_t window_size = default_window_size);
+    /**
+     * Tell the other party that we are done and wait until it is done as
+     * well.  The channels must not be used afterwards.
+     */
+    ~ChannelMultiplexer();
+
+    ChannelMultiplexer(const ChannelMultiplexer&) = delete;
+    ChannelMultiplexer& operator=(const ChannelMultiplexer&) = delete;
+
+    /**
+     * Get the channel with the given id.
+     */
+    Conn_p channel(uint32_t id);
+
+    static constexpr size_t max_frame_size = 1 << 16;
+    static constexpr size_t default_window_size = 1 << 20;
+
+private:
+    class Channel;
+
+    std::shared_ptr<Channel> get_channel(uint32_t id);
+    void send_frame(uint32_t id, const uint8_t* buffer, size_t length);
+    void send_credit(uint32_t id, size_t credit);
+    void send_close();
+    void read_loop();
+
+    static constexpr uint32_t close_id = 0xffffffff;
+    // set in the length field of frames which return credit
+    static constexpr uint32_t credit_flag = 0x80000000;
+
+    Connection& connection_;
+    const size_t window_size_;
+    std::mutex send_mutex_;
+    bool close_sent_;
+    std::mutex channels_mutex_;
+    std::map<uint32_t, std::shared_ptr<Channel>> channels_;
+    bool reader_done_;
+    std::exception_ptr reader_error_;
+    std::thread reader_;
+};
+
+#endif // CHANNEL_MULTIPLEXER_HPP
@@ -23,10 +23,27 @@
 #ifndef CONNECTION_HPP
 #define CONNECTION_HPP
 
+#include <functional>
 #include <future>
+#include <initializer_list>
 #include <memory>
+#include <system_error>
 #include "util/util.hpp"
 
+/**
+ * Buffers for scatter/gather operations.
+ */
+struct const_buffer_t
+{
+    const uint8_t* data;
+    size_t size;
+};
+struct mutable_buffer_t
+{
+    uint8_t* data;
+    size_t size;
+};
+
 /**
  * Interface for a bidirectional channel
  */
@@ -71,6 +88,34 @@ public:
      */
     virtual void send(const uint8_t* buffer, size_t length) = 0;
     virtual void recv(uint8_t* buffer, size_t length) = 0;
+
+    /**
+     * Send/receive the concatenation of several buffers without length
+     * prefix, as if by a single send/recv.  This default implementation
+     * handles the buffers one by one.
+     */
+    virtual void send_v(const const_buffer_t* buffers, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            send(buffers[i].data, buffers[i].size);
+        }
+    }
+    virtual void recv_v(const mutable_buffer_t* buffers, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            recv(buffers[i].data, buffers[i].size);
+        }
+    }
+    void send_v(std::initializer_list<const_buffer_t> buffers)
+    {
+        send_v(buffers.begin(), buffers.size());
+    }
+    void recv_v(std::initializer_list<mutable_buffer_t> buffers)
+    {
+        recv_v(buffers.begin(), buffers.size());
+    }
     virtual std::future<size_t> async_send(const uint8_t* buffer, size_t length)
     {
         std::promise<size_t> promise;
@@ -85,6 +130,45 @@ public:
         promise.set_value(length);
         return promise.get_future();
     }
+
+    /**
+     * Handler for the callback based operations, called with the error and
+     * the number of bytes transferred.
+     */
+    using completion_handler_t = std::function<void(std::error_code, size_t)>;
+    /**
+     * Start sending/receiving and call handler on completion.  The buffer
+     * has to stay valid until then.  This default implementation completes
+     * the operation before returning.  Connections driven by an event loop
+     * run the handler in the loop instead, so that many sessions can share
+     * one I/O thread.
+     */
+    virtual void async_send(const uint8_t* buffer, size_t length, completion_handler_t handler)
+    {
+        try
+        {
+            send(buffer, length);
+        }
+        catch (const std::system_error& e)
+        {
+            handler(e.code(), 0);
+            return;
+        }
+        handler(std::error_code(), length);
+    }
+    virtual void async_recv(uint8_t* buffer, size_t length, completion_handler_t handler)
+    {
+        try
+        {
+            recv(buffer, length);
+        }
+        catch (const std::system_error& e)
+        {
+            handler(e.code(), 0);
+            return;
+        }
+        handler(std::error_code(), length);
+    }
 };
 
 using Conn_p = std::shared_ptr<Connection>;
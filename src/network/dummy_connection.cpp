@@ -20,19 +20,20 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include "dummy_connection.hpp"
 
 DummyConnection::DummyConnection(message_queue_t send_queue, message_queue_t recv_queue)
-    : send_queue_(send_queue), recv_queue_(recv_queue) {}
+    : send_queue_(send_queue), recv_queue_(recv_queue), pending_(), pending_offset_(0) {}
 
 DummyConnection::~DummyConnection() = default;
 
-std::pair<Conn_p, Conn_p> DummyConnection::make_dummies()
+std::pair<Conn_p, Conn_p> DummyConnection::make_dummies(size_t capacity)
 {
-    auto queue_12{std::make_shared<message_queue_t::element_type>()};
-    auto queue_21{std::make_shared<message_queue_t::element_type>()};
+    auto queue_12{std::make_shared<message_queue_t::element_type>(capacity)};
+    auto queue_21{std::make_shared<message_queue_t::element_type>(capacity)};
     auto conn1{std::make_shared<DummyConnection>(queue_12, queue_21)};
     auto conn2{std::make_shared<DummyConnection>(queue_21, queue_12)};
     assert(conn1->send_queue_ == conn2->recv_queue_);
@@ -43,21 +44,52 @@ std::pair<Conn_p, Conn_p> DummyConnection::make_dummies()
 
 void DummyConnection::send_message(const uint8_t *buffer, size_t size)
 {
-    send_queue_->enqueue(bytes_t(buffer, buffer + size));
+    send_queue_->push(bytes_t(buffer, buffer + size));
 }
 
 bytes_t DummyConnection::recv_message()
 {
-    return recv_queue_->dequeue();
+    assert(pending_offset_ == pending_.size());
+    return recv_queue_->pop();
 }
 
 void DummyConnection::send(const uint8_t* buffer, size_t length)
 {
-    send_queue_->enqueue(bytes_t(buffer, buffer + length));
+    if (length == 0)
+        return;
+    send_queue_->push(bytes_t(buffer, buffer + length));
 }
 void DummyConnection::recv(uint8_t* buffer, size_t length)
 {
-    auto tmp = recv_queue_->dequeue();
-    assert(tmp.size() == length);
-    std::memcpy(buffer, tmp.data(), length);
+    while (length > 0)
+    {
+        if (pending_offset_ == pending_.size())
+        {
+            pending_ = recv_queue_->pop();
+            pending_offset_ = 0;
+        }
+        auto n = std::min(length, pending_.size() - pending_offset_);
+        std::memcpy(buffer, pending_.data() + pending_offset_, n);
+        buffer += n;
+        length -= n;
+        pending_offset_ += n;
+    }
+}
+
+void DummyConnection::send_v(const const_buffer_t* buffers, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += buffers[i].size;
+    }
+    if (length == 0)
+        return;
+    bytes_t message(length);
+    auto it = message.begin();
+    for (size_t i = 0; i < count; ++i)
+    {
+        it = std::copy(buffers[i].data, buffers[i].data + buffers[i].size, it);
+    }
+    send_queue_->push(std::move(message));
 }
@@ -24,7 +24,7 @@
 #define DUMMY_CONNECTION_HPP
 
 #include "connection.hpp"
-#include "util/queue.hpp"
+#include "util/ring_buffer.hpp"
 
 /**
  * Dummy connection for testing purposes
@@ -32,12 +32,16 @@
 class DummyConnection : public Connection
 {
 public:
-    using message_queue_t = std::shared_ptr<Queue<bytes_t>>;
+    /**
+     * Each direction has a single sending and a single receiving thread.
+     */
+    using message_queue_t = std::shared_ptr<SPSCRingBuffer<bytes_t>>;
 
     /**
-     * Create a pair of connection objects that are connection to each other
+     * Create a pair of connection objects that are connection to each other.
+     * A sender blocks if capacity messages are in flight.
      */
-    static std::pair<Conn_p, Conn_p> make_dummies();
+    static std::pair<Conn_p, Conn_p> make_dummies(size_t capacity = 4096);
 
     DummyConnection(message_queue_t send_queue, message_queue_t recv_queue);
     virtual ~DummyConnection();
@@ -49,10 +53,18 @@ public:
     virtual bytes_t recv_message() override;
     virtual void send(const uint8_t* buffer, size_t length) override;
     virtual void recv(uint8_t* buffer, size_t length) override;
+    /**
+     * Gather the buffers into a single message.
+     */
+    using Connection::send_v;
+    virtual void send_v(const const_buffer_t* buffers, size_t count) override;
 
 // private:
     message_queue_t send_queue_;
     message_queue_t recv_queue_;
+    // partially read message, recv can read any length
+    bytes_t pending_;
+    size_t pending_offset_;
 };
 
 #endif // DUMMY_CONNECTION_HPP
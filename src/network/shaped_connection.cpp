@@ -0,0 +1,215 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include "shaped_connection.hpp"
+
+NetworkProfile NetworkProfile::lan()
+{
+    NetworkProfile profile;
+    profile.rtt = std::chrono::microseconds(200);
+    profile.bandwidth = 1e9;
+    return profile;
+}
+
+NetworkProfile NetworkProfile::wan()
+{
+    NetworkProfile profile;
+    profile.rtt = std::chrono::milliseconds(100);
+    profile.bandwidth = 1e8;
+    profile.jitter = std::chrono::milliseconds(1);
+    return profile;
+}
+
+
+ShapedConnection::ShapedConnection(Connection& connection, const NetworkProfile& profile)
+    : connection_(connection), profile_(profile), mutex_(), cv_(), queue_(), bytes_queued_(0),
+      link_free_(), last_arrival_(), rng_(std::random_device()()), stop_(false), error_(), deliverer_()
+{
+    deliverer_ = std::thread([this] { deliver_loop(); });
+}
+
+ShapedConnection::~ShapedConnection()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    deliverer_.join();
+}
+
+void ShapedConnection::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    // packets are popped before they are sent, but only counted afterwards
+    cv_.wait(lock, [this] { return bytes_queued_ == 0 || error_; });
+    if (error_)
+        std::rethrow_exception(error_);
+}
+
+void ShapedConnection::enqueue(const const_buffer_t* buffers, size_t count, bool is_message)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += buffers[i].size;
+    }
+    // messages are not split, since the other party receives them at once
+    const auto packet_size = (is_message || profile_.packet_size == 0) ? std::max<size_t>(length, 1) : profile_.packet_size;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    size_t i = 0;
+    size_t done = 0;
+    size_t remaining = length;
+    do
+    {
+        const auto size = std::min(packet_size, remaining);
+        // a single packet may exceed the buffer size
+        cv_.wait(lock, [this, size] { return bytes_queued_ == 0 || bytes_queued_ + size <= profile_.buffer_size || error_; });
+        if (error_)
+            std::rethrow_exception(error_);
+
+        Packet packet{clock::time_point(), is_message, bytes_t(size)};
+        for (size_t offset = 0; offset < size;)
+        {
+            auto n = std::min(size - offset, buffers[i].size - done);
+            std::copy(buffers[i].data + done, buffers[i].data + done + n, packet.data.begin() + offset);
+            offset += n;
+            done += n;
+            if (done == buffers[i].size)
+            {
+                ++i;
+                done = 0;
+            }
+        }
+
+        const auto now = clock::now();
+        link_free_ = std::max(link_free_, now);
+        if (profile_.bandwidth > 0)
+            link_free_ += std::chrono::duration_cast<clock::duration>(
+                std::chrono::duration<double>(8.0 * size / profile_.bandwidth));
+        auto arrival = link_free_ + profile_.rtt / 2;
+        if (profile_.jitter.count() > 0)
+        {
+            std::uniform_int_distribution<int64_t> jitter(0, profile_.jitter.count());
+            arrival += std::chrono::microseconds(jitter(rng_));
+        }
+        // packets do not overtake each other
+        last_arrival_ = std::max(last_arrival_, arrival);
+        packet.arrival = last_arrival_;
+
+        bytes_queued_ += size;
+        queue_.push_back(std::move(packet));
+        remaining -= size;
+        cv_.notify_all();
+    } while (remaining > 0);
+}
+
+void ShapedConnection::deliver_loop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cv_.wait(lock, [this] { return !queue_.empty() || stop_; });
+        if (queue_.empty())
+            break;
+        const auto arrival = queue_.front().arrival;
+        // new packets are only appended, so the front stays the same
+        if (cv_.wait_until(lock, arrival, [this, arrival] { return clock::now() >= arrival; }) == false)
+            continue;
+        auto packet = std::move(queue_.front());
+        queue_.pop_front();
+        lock.unlock();
+        try
+        {
+            if (packet.is_message)
+                connection_.send_message(packet.data.data(), packet.data.size());
+            else
+                connection_.send(packet.data.data(), packet.data.size());
+        }
+        catch (...)
+        {
+            lock.lock();
+            error_ = std::current_exception();
+            queue_.clear();
+            bytes_queued_ = 0;
+            cv_.notify_all();
+            break;
+        }
+        lock.lock();
+        bytes_queued_ -= packet.data.size();
+        cv_.notify_all();
+    }
+}
+
+
+void ShapedConnection::send_message(const uint8_t* buffer, size_t length)
+{
+    const_buffer_t buffers[] = {{buffer, length}};
+    enqueue(buffers, 1, true);
+}
+
+bytes_t ShapedConnection::recv_message()
+{
+    return connection_.recv_message();
+}
+
+void ShapedConnection::send(const uint8_t* buffer, size_t length)
+{
+    if (length == 0)
+        return;
+    const_buffer_t buffers[] = {{buffer, length}};
+    enqueue(buffers, 1, false);
+}
+
+void ShapedConnection::recv(uint8_t* buffer, size_t length)
+{
+    connection_.recv(buffer, length);
+}
+
+void ShapedConnection::send_v(const const_buffer_t* buffers, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += buffers[i].size;
+    }
+    if (length == 0)
+        return;
+    enqueue(buffers, count, false);
+}
+
+void ShapedConnection::recv_v(const mutable_buffer_t* buffers, size_t count)
+{
+    connection_.recv_v(buffers, count);
+}
+
+std::future<size_t> ShapedConnection::async_recv(uint8_t* buffer, size_t length)
+{
+    return connection_.async_recv(buffer, length);
+}
+
+void ShapedConnection::async_recv(uint8_t* buffer, size_t length, completion_handler_t handler)
+{
+    connection_.async_recv(buffer, length, std::move(handler));
+}
@@ -0,0 +1,127 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHAPED_CONNECTION_HPP
+#define SHAPED_CONNECTION_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <thread>
+#include "connection.hpp"
+
+/**
+ * Characteristics of an emulated network link.
+ */
+struct NetworkProfile
+{
+    /** Round trip time, each direction adds half of it. */
+    std::chrono::microseconds rtt{0};
+    /** Bandwidth in bit/s, 0 for unlimited. */
+    double bandwidth = 0;
+    /** Maximum additional random delay per packet. */
+    std::chrono::microseconds jitter{0};
+    /** Data is paced in packets of this size, 0 to release each send at once. */
+    size_t packet_size = 1500;
+    /** Sends block while this many bytes are in flight. */
+    size_t buffer_size = 1 << 22;
+
+    /** 1 Gbit/s with 0.2 ms RTT. */
+    static NetworkProfile lan();
+    /** 100 Mbit/s with 100 ms RTT and 1 ms jitter. */
+    static NetworkProfile wan();
+};
+
+/**
+ * Decorator which delays the data sent over a connection as a network link
+ * with the given profile would.
+ *
+ * A send returns as soon as the data is queued (as with a socket buffer).  A
+ * background thread hands every packet to the underlying connection at the
+ * time it would arrive at the other party, i.e. after it has been serialized
+ * at the given bandwidth and has travelled for half the RTT plus jitter.
+ * Packets keep their order.  Receiving is not affected, so both parties
+ * should use a ShapedConnection.  The underlying connection has to support
+ * recv of any length if packets are paced.
+ */
+class ShapedConnection : public Connection
+{
+public:
+    ShapedConnection(Connection& connection, const NetworkProfile& profile);
+    /**
+     * Delivers the remaining packets.
+     */
+    ~ShapedConnection();
+
+    ShapedConnection(const ShapedConnection&) = delete;
+    ShapedConnection& operator=(const ShapedConnection&) = delete;
+
+    /**
+     * Wait until all queued data is handed to the underlying connection.
+     */
+    void flush();
+
+    void send_message(const uint8_t* buffer, size_t length) override;
+    bytes_t recv_message() override;
+    void send(const uint8_t* buffer, size_t length) override;
+    void recv(uint8_t* buffer, size_t length) override;
+    void send_v(const const_buffer_t* buffers, size_t count) override;
+    void recv_v(const mutable_buffer_t* buffers, size_t count) override;
+    std::future<size_t> async_recv(uint8_t* buffer, size_t length) override;
+    void async_recv(uint8_t* buffer, size_t length, completion_handler_t handler) override;
+    using Connection::send_message;
+    using Connection::async_send;
+    using Connection::send_v;
+    using Connection::recv_v;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct Packet
+    {
+        clock::time_point arrival;
+        bool is_message;
+        bytes_t data;
+    };
+
+    void enqueue(const const_buffer_t* buffers, size_t count, bool is_message);
+    void deliver_loop();
+
+    Connection& connection_;
+    const NetworkProfile profile_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Packet> queue_;
+    size_t bytes_queued_;
+    // time when the emulated link has sent all queued packets
+    clock::time_point link_free_;
+    clock::time_point last_arrival_;
+    std::mt19937_64 rng_;
+    bool stop_;
+    std::exception_ptr error_;
+    std::thread deliverer_;
+};
+
+#endif // SHAPED_CONNECTION_HPP
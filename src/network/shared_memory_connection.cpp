@@ -0,0 +1,392 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "shared_memory_connection.hpp"
+#include "util/options.hpp"
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "futex word has to be lock-free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring indices have to be lock-free");
+
+namespace
+{
+
+const uint64_t region_magic = 0x53484d434f4e4e31;
+const size_t page_size = 4096;
+
+/**
+ * Shared state of one direction.  Lives in the shared memory region.
+ */
+struct RingControl
+{
+    // number of bytes read so far, written by the receiver
+    alignas(64) std::atomic<uint64_t> head;
+    // number of bytes written so far, written by the sender
+    alignas(64) std::atomic<uint64_t> tail;
+    // futex words and number of parked threads
+    alignas(64) std::atomic<uint32_t> data_event;
+    std::atomic<uint32_t> data_waiters;
+    alignas(64) std::atomic<uint32_t> space_event;
+    std::atomic<uint32_t> space_waiters;
+};
+
+struct RegionHeader
+{
+    uint64_t magic;
+    uint64_t capacity;
+    RingControl rings[2];
+};
+
+const size_t data_offset = (sizeof(RegionHeader) + page_size - 1) / page_size * page_size;
+
+size_t region_size(size_t capacity)
+{
+    return data_offset + 2 * capacity;
+}
+
+void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Wait until ready() returns true.  Spin first, then sleep on the futex
+ * event, which is incremented by signal.
+ */
+template <typename F>
+void wait_for(std::atomic<uint32_t>& event, std::atomic<uint32_t>& waiters, F ready)
+{
+    for (size_t i = 0; i < 4096; ++i)
+    {
+        if (ready())
+            return;
+        cpu_relax();
+    }
+    for (size_t i = 0; i < 16; ++i)
+    {
+        if (ready())
+            return;
+        std::this_thread::yield();
+    }
+    while (true)
+    {
+        auto value = event.load(std::memory_order_acquire);
+        waiters.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in signal
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ready())
+        {
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+        // returns immediately if the event has been signalled since the load
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&event), FUTEX_WAIT, value, nullptr, nullptr, 0);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+void signal(std::atomic<uint32_t>& event, std::atomic<uint32_t>& waiters)
+{
+    event.fetch_add(1, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) > 0)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&event), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+}  // namespace
+
+/**
+ * One endpoint's view of a direction.  The cached index of the other side
+ * avoids touching its cache line for every operation.
+ */
+struct SharedMemoryConnection::Ring
+{
+    RingControl* control;
+    uint8_t* data;
+    uint64_t mask;
+    uint64_t cached_index;
+
+    /**
+     * Copy the concatenation of the buffers into the ring.  The tail is
+     * published once per round, i.e. whenever the ring is full or all
+     * buffers are written.
+     */
+    void write(const const_buffer_t* buffers, size_t count)
+    {
+        auto& c = *control;
+        const auto capacity = mask + 1;
+        auto tail = c.tail.load(std::memory_order_relaxed);
+        size_t i = 0;
+        size_t done = 0;
+        while (true)
+        {
+            while (i < count && done == buffers[i].size)
+            {
+                ++i;
+                done = 0;
+            }
+            if (i == count)
+                break;
+            if (tail - cached_index == capacity)
+            {
+                wait_for(c.space_event, c.space_waiters, [&]
+                    {
+                        cached_index = c.head.load(std::memory_order_acquire);
+                        return tail - cached_index < capacity;
+                    });
+            }
+            auto space = capacity - (tail - cached_index);
+            while (space > 0 && i < count)
+            {
+                auto n = std::min<uint64_t>(space, buffers[i].size - done);
+                auto offset = tail & mask;
+                auto first = std::min<uint64_t>(n, capacity - offset);
+                std::memcpy(data + offset, buffers[i].data + done, first);
+                std::memcpy(data, buffers[i].data + done + first, n - first);
+                tail += n;
+                space -= n;
+                done += n;
+                if (done == buffers[i].size)
+                {
+                    ++i;
+                    done = 0;
+                }
+            }
+            c.tail.store(tail, std::memory_order_release);
+            signal(c.data_event, c.data_waiters);
+        }
+    }
+
+    /**
+     * Fill the buffers from the ring.
+     */
+    void read(const mutable_buffer_t* buffers, size_t count)
+    {
+        auto& c = *control;
+        const auto capacity = mask + 1;
+        auto head = c.head.load(std::memory_order_relaxed);
+        size_t i = 0;
+        size_t done = 0;
+        while (true)
+        {
+            while (i < count && done == buffers[i].size)
+            {
+                ++i;
+                done = 0;
+            }
+            if (i == count)
+                break;
+            if (cached_index == head)
+            {
+                wait_for(c.data_event, c.data_waiters, [&]
+                    {
+                        cached_index = c.tail.load(std::memory_order_acquire);
+                        return cached_index != head;
+                    });
+            }
+            auto available = cached_index - head;
+            while (available > 0 && i < count)
+            {
+                auto n = std::min<uint64_t>(available, buffers[i].size - done);
+                auto offset = head & mask;
+                auto first = std::min<uint64_t>(n, capacity - offset);
+                std::memcpy(buffers[i].data + done, data + offset, first);
+                std::memcpy(buffers[i].data + done + first, data, n - first);
+                head += n;
+                available -= n;
+                done += n;
+                if (done == buffers[i].size)
+                {
+                    ++i;
+                    done = 0;
+                }
+            }
+            c.head.store(head, std::memory_order_release);
+            signal(c.space_event, c.space_waiters);
+        }
+    }
+};
+
+
+int SharedMemoryConnection::create_region(size_t capacity)
+{
+    if (capacity == 0 || capacity > (size_t(1) << 40))
+        throw std::invalid_argument("invalid shared memory capacity");
+    size_t rounded = page_size;
+    while (rounded < capacity)
+        rounded *= 2;
+
+    int fd = memfd_create("party-connection", MFD_CLOEXEC);
+    if (fd < 0)
+        throw std::system_error(errno, std::generic_category(), "memfd_create");
+    const auto size = region_size(rounded);
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        auto error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "ftruncate");
+    }
+    void* mapping = mmap(nullptr, data_offset, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        auto error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "mmap");
+    }
+    auto header = new (mapping) RegionHeader();
+    header->magic = region_magic;
+    header->capacity = rounded;
+    munmap(mapping, data_offset);
+    return fd;
+}
+
+std::pair<Conn_p, Conn_p> SharedMemoryConnection::make_pair(size_t capacity)
+{
+    int fd = create_region(capacity);
+    try
+    {
+        auto server{std::make_shared<SharedMemoryConnection>(fd, Role::server)};
+        auto client{std::make_shared<SharedMemoryConnection>(fd, Role::client)};
+        close(fd);
+        return {server, client};
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+}
+
+SharedMemoryConnection::SharedMemoryConnection(int fd, Role role)
+    : send_ring_(), recv_ring_()
+{
+    struct stat status;
+    if (fstat(fd, &status) != 0)
+        throw std::system_error(errno, std::generic_category(), "fstat");
+    if (static_cast<size_t>(status.st_size) < data_offset)
+        throw std::invalid_argument("not a shared memory connection region");
+    mapping_size_ = static_cast<size_t>(status.st_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping_ == MAP_FAILED)
+    {
+        mapping_ = nullptr;
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    auto header = static_cast<RegionHeader*>(mapping_);
+    const auto capacity = header->capacity;
+    if (header->magic != region_magic || capacity == 0 || (capacity & (capacity - 1)) != 0
+        || region_size(capacity) != mapping_size_)
+    {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        throw std::invalid_argument("not a shared memory connection region");
+    }
+    auto data = static_cast<uint8_t*>(mapping_) + data_offset;
+    // the server sends on ring 0, the client on ring 1
+    const size_t send_index = role == Role::server ? 0 : 1;
+    auto& send_control = header->rings[send_index];
+    auto& recv_control = header->rings[1 - send_index];
+    send_ring_.reset(new Ring{&send_control, data + send_index * capacity, capacity - 1,
+                              send_control.head.load(std::memory_order_acquire)});
+    recv_ring_.reset(new Ring{&recv_control, data + (1 - send_index) * capacity, capacity - 1,
+                              recv_control.tail.load(std::memory_order_acquire)});
+}
+
+SharedMemoryConnection::~SharedMemoryConnection()
+{
+    if (mapping_ != nullptr)
+        munmap(mapping_, mapping_size_);
+}
+
+SharedMemoryConnection::SharedMemoryConnection(SharedMemoryConnection&& other)
+    : Connection(std::move(other)),
+      mapping_(std::exchange(other.mapping_, nullptr)),
+      mapping_size_(std::exchange(other.mapping_size_, 0)),
+      send_ring_(std::move(other.send_ring_)),
+      recv_ring_(std::move(other.recv_ring_))
+{
+}
+
+SharedMemoryConnection& SharedMemoryConnection::operator=(SharedMemoryConnection&& other)
+{
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+    std::swap(send_ring_, other.send_ring_);
+    std::swap(recv_ring_, other.recv_ring_);
+    return *this;
+}
+
+
+void SharedMemoryConnection::send_message(const uint8_t* buffer, size_t length)
+{
+    uint64_t header = length;
+    send_v({{reinterpret_cast<const uint8_t*>(&header), sizeof(header)}, {buffer, length}});
+}
+
+bytes_t SharedMemoryConnection::recv_message()
+{
+    uint64_t length;
+    recv(reinterpret_cast<uint8_t*>(&length), sizeof(length));
+    bytes_t buffer(length);
+    recv(buffer.data(), length);
+    return buffer;
+}
+
+void SharedMemoryConnection::send(const uint8_t* buffer, size_t length)
+{
+    const_buffer_t buffers[] = {{buffer, length}};
+    send_ring_->write(buffers, 1);
+}
+
+void SharedMemoryConnection::recv(uint8_t* buffer, size_t length)
+{
+    mutable_buffer_t buffers[] = {{buffer, length}};
+    recv_ring_->read(buffers, 1);
+}
+
+void SharedMemoryConnection::send_v(const const_buffer_t* buffers, size_t count)
+{
+    send_ring_->write(buffers, count);
+}
+
+void SharedMemoryConnection::recv_v(const mutable_buffer_t* buffers, size_t count)
+{
+    recv_ring_->read(buffers, count);
+}
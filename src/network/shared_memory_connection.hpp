@@ -0,0 +1,97 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHARED_MEMORY_CONNECTION_HPP
+#define SHARED_MEMORY_CONNECTION_HPP
+
+#include "connection.hpp"
+
+enum class Role;
+
+/**
+ * Bidirectional channel over shared memory.
+ *
+ * Both directions are byte rings in a single memory region, which is backed
+ * by a memfd so that it can be shared between threads as well as processes.
+ * Data is copied directly from the send buffer into the ring and from the
+ * ring into the receive buffer.  Unlike DummyConnection, recv can read any
+ * length regardless of how the data was sent.  Each direction has a single
+ * sending and a single receiving thread.
+ */
+class SharedMemoryConnection : public Connection
+{
+public:
+    /**
+     * Create a memfd with capacity bytes per direction, rounded up to a power
+     * of two.  The file descriptor can be passed to another process (e.g. by
+     * fork or over a unix socket), and is owned by the caller.
+     */
+    static int create_region(size_t capacity = default_capacity);
+    /**
+     * Create a pair of connection objects that are connected to each other.
+     */
+    static std::pair<Conn_p, Conn_p> make_pair(size_t capacity = default_capacity);
+
+    /**
+     * Map the region behind fd.  The server and the client use the rings in
+     * opposite directions.  The fd can be closed afterwards.
+     */
+    SharedMemoryConnection(int fd, Role role);
+    ~SharedMemoryConnection();
+
+    SharedMemoryConnection(SharedMemoryConnection&&);
+    SharedMemoryConnection& operator=(SharedMemoryConnection&&);
+    SharedMemoryConnection(const SharedMemoryConnection&) = delete;
+    SharedMemoryConnection& operator=(const SharedMemoryConnection&) = delete;
+
+    /**
+     * Send/receive message prefixed with its length.
+     */
+    virtual void send_message(const uint8_t* buffer, size_t length) override;
+    virtual bytes_t recv_message() override;
+
+    /**
+     * Send/receive without length prefix.
+     */
+    virtual void send(const uint8_t* buffer, size_t length) override;
+    virtual void recv(uint8_t* buffer, size_t length) override;
+
+    /**
+     * Scatter/gather directly from/into the ring.
+     */
+    using Connection::send_v;
+    using Connection::recv_v;
+    virtual void send_v(const const_buffer_t* buffers, size_t count) override;
+    virtual void recv_v(const mutable_buffer_t* buffers, size_t count) override;
+
+    static constexpr size_t default_capacity = 1 << 20;
+
+private:
+    struct Ring;
+
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
+    std::unique_ptr<Ring> send_ring_;
+    std::unique_ptr<Ring> recv_ring_;
+};
+
+#endif // SHARED_MEMORY_CONNECTION_HPP
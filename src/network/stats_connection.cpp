@@ -0,0 +1,202 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <iomanip>
+#include "stats_connection.hpp"
+
+std::ostream& operator<<(std::ostream& os, const ConnectionStats& stats)
+{
+    os << "Sent: " << stats.bytes_sent << " bytes in " << stats.messages_sent << " messages\n"
+       << "Received: " << stats.bytes_received << " bytes in " << stats.messages_received << " messages\n"
+       << "Round trips: " << stats.round_trips << "\n"
+       << "Time blocked in recv: "
+       << std::chrono::duration_cast<std::chrono::microseconds>(stats.recv_blocked).count() << " us\n";
+    for (size_t i = 0; i < ConnectionStats::number_buckets; ++i)
+    {
+        if (stats.recv_blocked_histogram[i] == 0)
+            continue;
+        const uint64_t lower = i == 0 ? 0 : uint64_t(1) << (i - 1);
+        os << "  >= " << std::setw(10) << lower << " us: " << stats.recv_blocked_histogram[i] << "\n";
+    }
+    return os;
+}
+
+
+StatsConnection::StatsConnection(Connection& connection)
+    : connection_(connection), bytes_sent_(0), bytes_received_(0), messages_sent_(0),
+      messages_received_(0), round_trips_(0), last_was_send_(false), recv_blocked_(0), histogram_()
+{
+}
+
+ConnectionStats StatsConnection::snapshot() const
+{
+    ConnectionStats stats;
+    stats.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    stats.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    stats.messages_sent = messages_sent_.load(std::memory_order_relaxed);
+    stats.messages_received = messages_received_.load(std::memory_order_relaxed);
+    stats.round_trips = round_trips_.load(std::memory_order_relaxed);
+    stats.recv_blocked = std::chrono::nanoseconds(recv_blocked_.load(std::memory_order_relaxed));
+    for (size_t i = 0; i < ConnectionStats::number_buckets; ++i)
+    {
+        stats.recv_blocked_histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void StatsConnection::reset()
+{
+    bytes_sent_.store(0, std::memory_order_relaxed);
+    bytes_received_.store(0, std::memory_order_relaxed);
+    messages_sent_.store(0, std::memory_order_relaxed);
+    messages_received_.store(0, std::memory_order_relaxed);
+    round_trips_.store(0, std::memory_order_relaxed);
+    last_was_send_.store(false, std::memory_order_relaxed);
+    recv_blocked_.store(0, std::memory_order_relaxed);
+    for (auto& bucket : histogram_)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+void StatsConnection::count_send(size_t length)
+{
+    bytes_sent_.fetch_add(length, std::memory_order_relaxed);
+    messages_sent_.fetch_add(1, std::memory_order_relaxed);
+    last_was_send_.store(true, std::memory_order_relaxed);
+}
+
+void StatsConnection::count_recv(size_t length)
+{
+    bytes_received_.fetch_add(length, std::memory_order_relaxed);
+    messages_received_.fetch_add(1, std::memory_order_relaxed);
+    if (last_was_send_.exchange(false, std::memory_order_relaxed))
+        round_trips_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void StatsConnection::record_blocked(clock::duration duration)
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    recv_blocked_.fetch_add(ns, std::memory_order_relaxed);
+    auto us = static_cast<uint64_t>(ns / 1000);
+    size_t bucket = 0;
+    while (us > 0 && bucket + 1 < ConnectionStats::number_buckets)
+    {
+        us >>= 1;
+        ++bucket;
+    }
+    histogram_[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+
+void StatsConnection::send_message(const uint8_t* buffer, size_t length)
+{
+    count_send(length);
+    connection_.send_message(buffer, length);
+}
+
+bytes_t StatsConnection::recv_message()
+{
+    auto start = clock::now();
+    auto message = connection_.recv_message();
+    record_blocked(clock::now() - start);
+    count_recv(message.size());
+    return message;
+}
+
+void StatsConnection::send(const uint8_t* buffer, size_t length)
+{
+    count_send(length);
+    connection_.send(buffer, length);
+}
+
+void StatsConnection::recv(uint8_t* buffer, size_t length)
+{
+    auto start = clock::now();
+    connection_.recv(buffer, length);
+    record_blocked(clock::now() - start);
+    count_recv(length);
+}
+
+void StatsConnection::send_v(const const_buffer_t* buffers, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += buffers[i].size;
+    }
+    count_send(length);
+    connection_.send_v(buffers, count);
+}
+
+void StatsConnection::recv_v(const mutable_buffer_t* buffers, size_t count)
+{
+    size_t length = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        length += buffers[i].size;
+    }
+    auto start = clock::now();
+    connection_.recv_v(buffers, count);
+    record_blocked(clock::now() - start);
+    count_recv(length);
+}
+
+std::future<size_t> StatsConnection::async_send(const uint8_t* buffer, size_t length)
+{
+    count_send(length);
+    return connection_.async_send(buffer, length);
+}
+
+std::future<size_t> StatsConnection::async_recv(uint8_t* buffer, size_t length)
+{
+    // connections with the default implementation already block here
+    auto start = clock::now();
+    auto future = connection_.async_recv(buffer, length);
+    const auto initiate = clock::now() - start;
+    // the deferred function runs in the thread which waits for the result
+    return std::async(std::launch::deferred, [this, initiate, future = std::move(future)]() mutable
+        {
+            auto start = clock::now();
+            auto size = future.get();
+            record_blocked(initiate + (clock::now() - start));
+            count_recv(size);
+            return size;
+        });
+}
+
+void StatsConnection::async_send(const uint8_t* buffer, size_t length, completion_handler_t handler)
+{
+    count_send(length);
+    connection_.async_send(buffer, length, std::move(handler));
+}
+
+void StatsConnection::async_recv(uint8_t* buffer, size_t length, completion_handler_t handler)
+{
+    // nobody blocks here, so only the traffic is counted
+    connection_.async_recv(buffer, length,
+        [this, handler = std::move(handler)](std::error_code error, size_t size)
+        {
+            count_recv(size);
+            handler(error, size);
+        });
+}
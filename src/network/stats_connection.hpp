@@ -0,0 +1,103 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STATS_CONNECTION_HPP
+#define STATS_CONNECTION_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "connection.hpp"
+
+/**
+ * Snapshot of the statistics of a StatsConnection.
+ */
+struct ConnectionStats
+{
+    /**
+     * Bucket i counts the receives that blocked for [2^(i-1), 2^i)
+     * microseconds, bucket 0 those below one microsecond.  The last bucket
+     * also contains everything longer.
+     */
+    static constexpr size_t number_buckets = 32;
+
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint64_t messages_sent = 0;
+    uint64_t messages_received = 0;
+    /** Number of times the direction changed from sending to receiving. */
+    uint64_t round_trips = 0;
+    /** Total time blocked in recv and while waiting for async_recv. */
+    std::chrono::nanoseconds recv_blocked{0};
+    std::array<uint64_t, number_buckets> recv_blocked_histogram{};
+};
+
+std::ostream& operator<<(std::ostream& os, const ConnectionStats& stats);
+
+/**
+ * Decorator which counts the traffic of a connection and measures the time
+ * spent waiting for data.  Every send resp. receive call counts as one
+ * message.
+ */
+class StatsConnection : public Connection
+{
+public:
+    explicit StatsConnection(Connection& connection);
+
+    ConnectionStats snapshot() const;
+    void reset();
+
+    void send_message(const uint8_t* buffer, size_t length) override;
+    bytes_t recv_message() override;
+    void send(const uint8_t* buffer, size_t length) override;
+    void recv(uint8_t* buffer, size_t length) override;
+    void send_v(const const_buffer_t* buffers, size_t count) override;
+    void recv_v(const mutable_buffer_t* buffers, size_t count) override;
+    std::future<size_t> async_send(const uint8_t* buffer, size_t length) override;
+    std::future<size_t> async_recv(uint8_t* buffer, size_t length) override;
+    void async_send(const uint8_t* buffer, size_t length, completion_handler_t handler) override;
+    void async_recv(uint8_t* buffer, size_t length, completion_handler_t handler) override;
+    using Connection::send_message;
+    using Connection::send_v;
+    using Connection::recv_v;
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    void count_send(size_t length);
+    void count_recv(size_t length);
+    void record_blocked(clock::duration duration);
+
+    Connection& connection_;
+    std::atomic<uint64_t> bytes_sent_;
+    std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> messages_sent_;
+    std::atomic<uint64_t> messages_received_;
+    std::atomic<uint64_t> round_trips_;
+    std::atomic<bool> last_was_send_;
+    std::atomic<int64_t> recv_blocked_;
+    std::array<std::atomic<uint64_t>, ConnectionStats::number_buckets> histogram_;
+};
+
+#endif // STATS_CONNECTION_HPP
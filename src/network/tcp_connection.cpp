@@ -20,6 +20,15 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <cerrno>
+#include <future>
+#include <limits>
+#include <memory>
+#include <system_error>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include "tcp_connection.hpp"
@@ -28,53 +37,98 @@
 using boost::asio::ip::tcp;
 
 
-TCPConnection::TCPConnection(tcp::socket socket)
-    : socket_(std::move(socket))
+static void set_socket_option(int fd, int level, int name, int value)
 {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) != 0)
+        throw std::system_error(errno, std::generic_category(), "setsockopt");
+}
+
+/**
+ * Options that have to be set before connecting resp. listening.  Connected
+ * sockets keep them, so the constructor does not set them again.
+ */
+static void set_buffer_options(int fd, const SocketOptions& options)
+{
+    if (options.send_buffer_size > 0)
+        set_socket_option(fd, SOL_SOCKET, SO_SNDBUF, options.send_buffer_size);
+    if (options.receive_buffer_size > 0)
+        set_socket_option(fd, SOL_SOCKET, SO_RCVBUF, options.receive_buffer_size);
+}
+
+
+TCPConnection::TCPConnection(tcp::socket socket, const SocketOptions& options)
+    : socket_(std::move(socket)), quick_ack_(options.quick_ack)
+{
+    const auto fd = socket_.native_handle();
+    if (options.no_delay)
+        set_socket_option(fd, IPPROTO_TCP, TCP_NODELAY, 1);
+    if (options.quick_ack)
+        set_socket_option(fd, IPPROTO_TCP, TCP_QUICKACK, 1);
+    if (options.busy_poll > 0)
+        set_socket_option(fd, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll);
 }
 
 
 Conn_p TCPConnection::from_role(Role role, boost::asio::io_service &io_service,
-        std::string address, uint16_t port)
+        std::string address, uint16_t port, const SocketOptions& options)
 {
     switch (role)
     {
         case Role::server:
-            return listen(io_service, address, port);
+            return listen(io_service, address, port, options);
         case Role::client:
-            return connect(io_service, address, port);
+            return connect(io_service, address, port, options);
     }
 }
 
 Conn_p TCPConnection::connect(boost::asio::io_service &io_service,
-        std::string address, uint16_t port)
+        std::string address, uint16_t port, const SocketOptions& options)
 {
     tcp::socket socket(io_service);
     tcp::resolver resolver(socket.get_io_service());
-    boost::asio::connect(socket, resolver.resolve({address, std::to_string(port)}));
-    return std::make_shared<TCPConnection>(std::move(socket));
+    boost::system::error_code error = boost::asio::error::host_not_found;
+    for (const auto& entry : resolver.resolve({address, std::to_string(port)}))
+    {
+        socket.close();
+        socket.open(entry.endpoint().protocol());
+        set_buffer_options(socket.native_handle(), options);
+        socket.connect(entry.endpoint(), error);
+        if (!error)
+            break;
+    }
+    if (error)
+        throw boost::system::system_error(error);
+    return std::make_shared<TCPConnection>(std::move(socket), options);
 }
 
 Conn_p TCPConnection::listen(boost::asio::io_service& io_service,
-        std::string address, uint16_t port)
+        std::string address, uint16_t port, const SocketOptions& options)
 {
     tcp::socket socket(io_service);
     tcp::endpoint endpoint(boost::asio::ip::address::from_string(address), port);
-    tcp::acceptor acceptor(socket.get_io_service(), endpoint);
+    tcp::acceptor acceptor(socket.get_io_service());
+    acceptor.open(endpoint.protocol());
+    acceptor.set_option(tcp::acceptor::reuse_address(options.reuse_address));
+    // accepted sockets inherit the buffer sizes
+    set_buffer_options(acceptor.native_handle(), options);
+    acceptor.bind(endpoint);
+    acceptor.listen();
     acceptor.accept(socket);
-    return std::make_shared<TCPConnection>(std::move(socket));
+    return std::make_shared<TCPConnection>(std::move(socket), options);
 }
 
-
-void TCPConnection::send_length(size_t length)
+void TCPConnection::after_recv()
 {
-    if (length > std::numeric_limits<uint32_t>::max())
-        throw std::out_of_range("message too long");
-    uint32_t header{htonl(static_cast<uint32_t>(length))};
-    static_assert(sizeof(header) == header_size, "header size mismatch");
-    boost::asio::write(socket_, boost::asio::buffer(&header, sizeof(header)));
+    // only a hint, and completion handlers must not throw
+    if (quick_ack_)
+    {
+        int value = 1;
+        setsockopt(socket_.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &value, sizeof(value));
+    }
 }
 
+
+
 size_t TCPConnection::recv_length()
 {
     uint32_t header{0};
@@ -85,8 +139,12 @@ size_t TCPConnection::recv_length()
 
 void TCPConnection::send_message(const uint8_t *buffer, size_t length)
 {
-    send_length(length);
-    boost::asio::write(socket_, boost::asio::buffer(buffer, length));
+    if (length > std::numeric_limits<uint32_t>::max())
+        throw std::out_of_range("message too long");
+    uint32_t header{htonl(static_cast<uint32_t>(length))};
+    static_assert(sizeof(header) == header_size, "header size mismatch");
+    // header and message in a single write
+    send_v({{reinterpret_cast<const uint8_t*>(&header), sizeof(header)}, {buffer, length}});
 }
 
 bytes_t TCPConnection::recv_message()
@@ -94,6 +152,7 @@ bytes_t TCPConnection::recv_message()
     auto length{recv_length()};
     bytes_t buffer(length);
     boost::asio::read(socket_, boost::asio::buffer(buffer));
+    after_recv();
     return buffer;
 }
 
@@ -105,6 +164,30 @@ void TCPConnection::send(const uint8_t* buffer, size_t length)
 void TCPConnection::recv(uint8_t* buffer, size_t length)
 {
     boost::asio::read(socket_, boost::asio::buffer(buffer, length));
+    after_recv();
+}
+
+void TCPConnection::send_v(const const_buffer_t* buffers, size_t count)
+{
+    std::vector<boost::asio::const_buffer> sequence;
+    sequence.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        sequence.emplace_back(buffers[i].data, buffers[i].size);
+    }
+    boost::asio::write(socket_, sequence);
+}
+
+void TCPConnection::recv_v(const mutable_buffer_t* buffers, size_t count)
+{
+    std::vector<boost::asio::mutable_buffer> sequence;
+    sequence.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        sequence.emplace_back(buffers[i].data, buffers[i].size);
+    }
+    boost::asio::read(socket_, sequence);
+    after_recv();
 }
 
 std::future<size_t> TCPConnection::async_send(const uint8_t* buffer, size_t length)
@@ -114,5 +197,39 @@ std::future<size_t> TCPConnection::async_send(const uint8_t* buffer, size_t leng
 }
 std::future<size_t> TCPConnection::async_recv(uint8_t* buffer, size_t length)
 {
-    return boost::asio::async_read(socket_, boost::asio::buffer(buffer, length), boost::asio::use_future);
+    // like use_future, but re-arms TCP_QUICKACK before completing
+    auto promise = std::make_shared<std::promise<size_t>>();
+    auto future = promise->get_future();
+    boost::asio::async_read(socket_, boost::asio::buffer(buffer, length),
+            [this, promise](const boost::system::error_code& error, size_t size)
+            {
+                if (error)
+                {
+                    promise->set_exception(std::make_exception_ptr(boost::system::system_error(error)));
+                    return;
+                }
+                after_recv();
+                promise->set_value(size);
+            });
+    return future;
+}
+
+void TCPConnection::async_send(const uint8_t* buffer, size_t length, completion_handler_t handler)
+{
+    boost::asio::async_write(socket_, boost::asio::buffer(buffer, length),
+            [handler = std::move(handler)](const boost::system::error_code& error, size_t size)
+            {
+                handler(error, size);
+            });
+}
+
+void TCPConnection::async_recv(uint8_t* buffer, size_t length, completion_handler_t handler)
+{
+    boost::asio::async_read(socket_, boost::asio::buffer(buffer, length),
+            [this, handler = std::move(handler)](const boost::system::error_code& error, size_t size)
+            {
+                if (!error)
+                    after_recv();
+                handler(error, size);
+            });
 }
@@ -28,6 +28,40 @@
 
 enum class Role;
 
+/**
+ * Tuning options for the socket of a TCPConnection.  The defaults keep the
+ * kernel's settings (except for SO_REUSEADDR on the listening socket).
+ */
+struct SocketOptions
+{
+    /** Disable Nagle's algorithm (TCP_NODELAY). */
+    bool no_delay = false;
+    /** Acknowledge received data immediately (TCP_QUICKACK).  The kernel
+     * resets this flag, so it is set again after every receive. */
+    bool quick_ack = false;
+    /** Socket buffer sizes in bytes (SO_SNDBUF/SO_RCVBUF), 0 for the
+     * default.  Set by connect/listen before connecting, so that the window
+     * scaling fits. */
+    int send_buffer_size = 0;
+    int receive_buffer_size = 0;
+    /** Busy poll the device queue for this many microseconds when waiting
+     * for data (SO_BUSY_POLL), 0 to disable. */
+    int busy_poll = 0;
+    /** Allow listening on an address in TIME_WAIT (SO_REUSEADDR). */
+    bool reuse_address = true;
+
+    /**
+     * Profile for protocols with many small round trips.
+     */
+    static SocketOptions low_latency()
+    {
+        SocketOptions options;
+        options.no_delay = true;
+        options.quick_ack = true;
+        return options;
+    }
+};
+
 /**
  * Implementation of a bidirectional channel over tcp
  */
@@ -35,9 +69,10 @@ class TCPConnection : public Connection
 {
 public:
     /**
-     * Constructor given a tcp socket
+     * Constructor given a connected tcp socket.  The buffer sizes of options
+     * are not applied, since they have to be set before connecting.
      */
-    TCPConnection(boost::asio::ip::tcp::socket socket);
+    TCPConnection(boost::asio::ip::tcp::socket socket, const SocketOptions& options = SocketOptions());
     ~TCPConnection() = default;
 
     TCPConnection(TCPConnection&&) = default;
@@ -47,17 +82,17 @@ public:
      * Dispatch to connect/listen according to role
      */
     static Conn_p from_role(Role role, boost::asio::io_context &io_service,
-        std::string address, uint16_t port);
+        std::string address, uint16_t port, const SocketOptions& options = SocketOptions());
     /**
      * Connect to another party
      */
     static Conn_p connect(boost::asio::io_context& io_service,
-            std::string address, uint16_t port);
+            std::string address, uint16_t port, const SocketOptions& options = SocketOptions());
     /**
      * Listen and wait for connection of another party
      */
     static Conn_p listen(boost::asio::io_context& io_service,
-            std::string address, uint16_t port);
+            std::string address, uint16_t port, const SocketOptions& options = SocketOptions());
 
     /**
      * Send/receive message prefixed with its length.
@@ -71,15 +106,29 @@ public:
     void send(const uint8_t* buffer, size_t length) override;
     void recv(uint8_t* buffer, size_t length) override;
 
+    /**
+     * Scatter/gather with a single asio buffer sequence, i.e. writev/readv.
+     */
+    using Connection::send_v;
+    using Connection::recv_v;
+    void send_v(const const_buffer_t* buffers, size_t count) override;
+    void recv_v(const mutable_buffer_t* buffers, size_t count) override;
+
     std::future<size_t> async_send(const uint8_t* buffer, size_t length) override;
     std::future<size_t> async_recv(uint8_t* buffer, size_t length) override;
+    /**
+     * The handler is run by the io_context of the socket.
+     */
+    void async_send(const uint8_t* buffer, size_t length, completion_handler_t handler) override;
+    void async_recv(uint8_t* buffer, size_t length, completion_handler_t handler) override;
 private:
 
-    void send_length(size_t length);
     size_t recv_length();
+    void after_recv();
 
     const static size_t header_size = 4;
     boost::asio::ip::tcp::socket socket_;
+    bool quick_ack_;
 };
 
 #endif // TCP_CONNECTION_HPP
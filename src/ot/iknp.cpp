@@ -0,0 +1,145 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <botan/blake2b.h>
+#include <botan/stream_cipher.h>
+#include "iknp.hpp"
+#include "util/threading.hpp"
+
+
+namespace iknp
+{
+
+prg_t make_prg(const ot_key_t& seed)
+{
+    auto prg = Botan::StreamCipher::create_or_throw("CTR-BE(AES-128)");
+    prg->set_key(seed.data(), seed.size());
+    return prg;
+}
+
+void hash_row(Botan::Blake2b& hash, uint8_t* output, uint64_t index, const uint8_t* row, size_t row_size)
+{
+    std::array<uint8_t, 8> index_bytes;
+    for (size_t i = 0; i < index_bytes.size(); ++i)
+    {
+        index_bytes[i] = static_cast<uint8_t>(index >> (8 * i));
+    }
+    hash.update(index_bytes.data(), index_bytes.size());
+    hash.update(row, row_size);
+    hash.final(output);
+}
+
+
+Sender::Sender(RandomOT& base_ot, size_t number_columns)
+    : base_ot_(base_ot), number_columns_(number_columns), ready_(false), s_(), prgs_()
+{
+}
+
+Sender::~Sender() = default;
+
+void Sender::setup(size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    // sample s <- {0,1}^k
+    s_ = random_bytes(number_columns_ / 8);
+
+    std::vector<bool> s_bits(number_columns_);
+    for (size_t i = 0; i < number_columns_; ++i)
+    {
+        s_bits[i] = get_bit(s_.data(), i);
+    }
+
+    // receive k_i^{s_i}
+    std::vector<ot_key_t> keys(number_columns_);
+    if (thread_pool == nullptr)
+        base_ot_.recv_into(keys.data(), s_bits);
+    else
+        base_ot_.parallel_recv_into(keys.data(), s_bits, number_threads, *thread_pool);
+
+    prgs_.clear();
+    for (const auto& key : keys)
+    {
+        prgs_.push_back(make_prg(key));
+    }
+    ready_ = true;
+}
+
+void Sender::compute_q(uint8_t* matrix, size_t column_size,
+                       size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    // q^i = G(k_i^{s_i}) xor s_i * u^i
+    for_each_index(thread_pool, number_threads, number_columns_,
+        [this, matrix, column_size](size_t i)
+        {
+            auto column = matrix + i * column_size;
+            if (!get_bit(s_.data(), i))
+                std::fill(column, column + column_size, 0);
+            prgs_[i]->cipher1(column, column_size);
+        });
+}
+
+
+Receiver::Receiver(RandomOT& base_ot, size_t number_columns)
+    : base_ot_(base_ot), number_columns_(number_columns), ready_(false), prgs_0_(), prgs_1_()
+{
+}
+
+Receiver::~Receiver() = default;
+
+void Receiver::setup(size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    // send (k_i^0, k_i^1)
+    std::vector<ot_key_t> keys(2 * number_columns_);
+    if (thread_pool == nullptr)
+        base_ot_.send_into(keys.data(), number_columns_);
+    else
+        base_ot_.parallel_send_into(keys.data(), number_columns_, number_threads, *thread_pool);
+
+    prgs_0_.clear();
+    prgs_1_.clear();
+    for (size_t i = 0; i < number_columns_; ++i)
+    {
+        prgs_0_.push_back(make_prg(keys[2 * i]));
+        prgs_1_.push_back(make_prg(keys[2 * i + 1]));
+    }
+    ready_ = true;
+}
+
+void Receiver::compute_t_u(uint8_t* matrix_t, uint8_t* matrix_u, size_t column_size,
+                           size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    // t^i = G(k_i^0)
+    // u^i = t^i xor G(k_i^1) xor r^i
+    for_each_index(thread_pool, number_threads, number_columns_,
+        [this, matrix_t, matrix_u, column_size](size_t i)
+        {
+            auto column_t = matrix_t + i * column_size;
+            auto column_u = matrix_u + i * column_size;
+            prgs_0_[i]->cipher1(column_t, column_size);
+            std::transform(column_t, column_t + column_size, column_u, column_u,
+                           [](auto a, auto b) { return a ^ b; });
+            prgs_1_[i]->cipher1(column_u, column_size);
+        });
+}
+
+}  // namespace iknp
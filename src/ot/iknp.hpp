@@ -0,0 +1,142 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef IKNP_HPP
+#define IKNP_HPP
+
+#include <memory>
+#include <vector>
+#include "ot.hpp"
+
+namespace Botan {
+    class Blake2b;
+    class StreamCipher;
+}
+
+
+/**
+ * The parts shared by the OT extensions in the style of Ishai, Kilian, Nissim,
+ * and Petrank (2003), i.e. OTExtension and OT_KK13.
+ *
+ * Notation:
+ * * k base OTs (with roles swapped), i.e. the matrices have k columns
+ * * m OTs to be extended, padded to a multiple of 64
+ * * PRG G: {0,1}^128 -> {0,1}^m (AES-128 in counter mode, the stream
+ *   continues across batches)
+ *
+ * The matrices T, U, Q are stored column-wise, i.e. as k columns with m bits
+ * (column_size bytes) each.  The row j of T and Q belongs to the j-th OT.
+ */
+namespace iknp
+{
+
+using prg_t = std::unique_ptr<Botan::StreamCipher>;
+
+prg_t make_prg(const ot_key_t& seed);
+
+inline bool get_bit(const uint8_t* buffer, size_t index)
+{
+    return (buffer[index / 8] >> (index % 8)) & 1;
+}
+
+inline size_t pad_number_ots(size_t number_ots)
+{
+    return (number_ots + 63) / 64 * 64;
+}
+
+/**
+ * Random oracle H(index, row).
+ */
+void hash_row(Botan::Blake2b& hash, uint8_t* output, uint64_t index, const uint8_t* row, size_t row_size);
+
+/**
+ * Sender side: knows s and k_i^{s_i}.
+ */
+class Sender
+{
+public:
+    Sender(RandomOT& base_ot, size_t number_columns);
+    ~Sender();
+
+    bool ready() const { return ready_; }
+
+    /**
+     * Sample s and receive k_i^{s_i} with the base OTs.  If thread_pool is
+     * nullptr everything is computed in the calling thread.
+     */
+    void setup(size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+    /**
+     * s as a row of k bits.
+     */
+    const uint8_t* s() const { return s_.data(); }
+
+    /**
+     * Replace the received U by Q: q^i = G(k_i^{s_i}) xor s_i * u^i.
+     */
+    void compute_q(uint8_t* matrix, size_t column_size,
+                   size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+private:
+    RandomOT& base_ot_;
+    const size_t number_columns_;
+    bool ready_;
+    bytes_t s_;
+    std::vector<prg_t> prgs_;
+};
+
+/**
+ * Receiver side: knows k_i^0 and k_i^1.
+ */
+class Receiver
+{
+public:
+    Receiver(RandomOT& base_ot, size_t number_columns);
+    ~Receiver();
+
+    bool ready() const { return ready_; }
+
+    /**
+     * Send (k_i^0, k_i^1) with the base OTs.
+     */
+    void setup(size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+    /**
+     * Given the columns r^i of the receiver's (encoded) choices in matrix_u,
+     * write t^i = G(k_i^0) to matrix_t and replace r^i by
+     * u^i = t^i xor G(k_i^1) xor r^i.
+     */
+    void compute_t_u(uint8_t* matrix_t, uint8_t* matrix_u, size_t column_size,
+                     size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+private:
+    RandomOT& base_ot_;
+    const size_t number_columns_;
+    bool ready_;
+    std::vector<prg_t> prgs_0_;
+    std::vector<prg_t> prgs_1_;
+};
+
+}  // namespace iknp
+
+
+#endif // IKNP_HPP
@@ -1,19 +1,114 @@
 #include <boost/asio/thread_pool.hpp>
 #include "ot.hpp"
+#include "util/threading.hpp"
 
 
-std::vector<std::pair<bytes_t, bytes_t>> RandomOT::parallel_send(size_t number_ots, size_t number_threads)
+static std::vector<std::pair<bytes_t, bytes_t>> to_key_pairs(const std::vector<ot_key_t>& keys)
 {
-    boost::asio::thread_pool thread_pool(number_threads);
-    auto output = parallel_send(number_ots, number_threads, thread_pool);
-    thread_pool.join();
+    std::vector<std::pair<bytes_t, bytes_t>> output(keys.size() / 2);
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        output[i].first.assign(keys[2 * i].cbegin(), keys[2 * i].cend());
+        output[i].second.assign(keys[2 * i + 1].cbegin(), keys[2 * i + 1].cend());
+    }
     return output;
 }
 
-std::vector<bytes_t> RandomOT::parallel_recv(const std::vector<bool>& choices, size_t number_threads)
+static std::vector<bytes_t> to_keys(const std::vector<ot_key_t>& keys)
 {
-    boost::asio::thread_pool thread_pool(number_threads);
-    auto output = parallel_recv(choices, number_threads, thread_pool);
-    thread_pool.join();
+    std::vector<bytes_t> output(keys.size());
+    for (size_t i = 0; i < output.size(); ++i)
+    {
+        output[i].assign(keys[i].cbegin(), keys[i].cend());
+    }
     return output;
 }
+
+
+std::vector<std::pair<bytes_t, bytes_t>> RandomOT::send(size_t number_ots)
+{
+    std::vector<ot_key_t> keys(2 * number_ots);
+    send_into(keys.data(), number_ots);
+    return to_key_pairs(keys);
+}
+
+std::vector<bytes_t> RandomOT::recv(const std::vector<bool>& choices)
+{
+    std::vector<ot_key_t> keys(choices.size());
+    recv_into(keys.data(), choices);
+    return to_keys(keys);
+}
+
+std::vector<std::pair<bytes_t, bytes_t>> RandomOT::parallel_send(size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    std::vector<ot_key_t> keys(2 * number_ots);
+    parallel_send_into(keys.data(), number_ots, number_threads, thread_pool);
+    return to_key_pairs(keys);
+}
+
+std::vector<bytes_t> RandomOT::parallel_recv(const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    std::vector<ot_key_t> keys(choices.size());
+    parallel_recv_into(keys.data(), choices, number_threads, thread_pool);
+    return to_keys(keys);
+}
+
+
+std::vector<std::pair<bytes_t, bytes_t>> RandomOT::parallel_send(size_t number_ots, size_t number_threads)
+{
+    return parallel_send(number_ots, number_threads, global_thread_pool());
+}
+
+std::vector<bytes_t> RandomOT::parallel_recv(const std::vector<bool>& choices, size_t number_threads)
+{
+    return parallel_recv(choices, number_threads, global_thread_pool());
+}
+
+void RandomOT::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads)
+{
+    parallel_send_into(output, number_ots, number_threads, global_thread_pool());
+}
+
+void RandomOT::parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads)
+{
+    parallel_recv_into(output, choices, number_threads, global_thread_pool());
+}
+
+void RandomOT::async_send_into(ot_key_t* output, size_t number_ots, done_handler_t done)
+{
+    try
+    {
+        send_into(output, number_ots);
+    }
+    catch (const std::system_error& e)
+    {
+        done(e.code());
+        return;
+    }
+    done(std::error_code());
+}
+
+void RandomOT::async_recv_into(ot_key_t* output, const std::vector<bool>& choices, done_handler_t done)
+{
+    try
+    {
+        recv_into(output, choices);
+    }
+    catch (const std::system_error& e)
+    {
+        done(e.code());
+        return;
+    }
+    done(std::error_code());
+}
+
+
+void RandomOT_N::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads)
+{
+    parallel_send_into(output, number_ots, number_threads, global_thread_pool());
+}
+
+void RandomOT_N::parallel_recv_into(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads)
+{
+    parallel_recv_into(output, choices, number_threads, global_thread_pool());
+}
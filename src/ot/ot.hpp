@@ -23,6 +23,9 @@
 #ifndef OT_HPP
 #define OT_HPP
 
+#include <array>
+#include <functional>
+#include <system_error>
 #include <vector>
 #include "util/util.hpp"
 
@@ -40,6 +43,11 @@ public:
     virtual bytes_t recv(size_t) = 0;
 };
 
+/**
+ * Key obtained from a random OT.
+ */
+using ot_key_t = std::array<uint8_t, 16>;
+
 class RandomOT
 {
 public:
@@ -54,11 +62,12 @@ public:
     /**
      * Send/receive parts of the random OT protocol (batch version).
      */
-    virtual std::vector<std::pair<bytes_t, bytes_t>> send(size_t) = 0;
-    virtual std::vector<bytes_t> recv(const std::vector<bool>&) = 0;
+    virtual std::vector<std::pair<bytes_t, bytes_t>> send(size_t);
+    virtual std::vector<bytes_t> recv(const std::vector<bool>&);
     /**
      * Parallelized version of batch send/receive.
-     * These methods will create a new thread pool.
+     * These methods will use the global thread pool (see global_thread_pool
+     * in util/threading.hpp).
      */
     virtual std::vector<std::pair<bytes_t, bytes_t>> parallel_send(size_t, size_t number_threads);
     virtual std::vector<bytes_t> parallel_recv(const std::vector<bool>&, size_t number_threads);
@@ -66,8 +75,72 @@ public:
      * Parallelized version of batch send/receive.
      * These methods will use the given thread pool.
      */
-    virtual std::vector<std::pair<bytes_t, bytes_t>> parallel_send(size_t, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
-    virtual std::vector<bytes_t> parallel_recv(const std::vector<bool>&, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
+    virtual std::vector<std::pair<bytes_t, bytes_t>> parallel_send(size_t, size_t number_threads, boost::asio::thread_pool& thread_pool);
+    virtual std::vector<bytes_t> parallel_recv(const std::vector<bool>&, size_t number_threads, boost::asio::thread_pool& thread_pool);
+
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     *
+     * The sender writes the keys (k_0, k_1) of the i-th OT to output[2*i] and
+     * output[2*i+1], i.e. output has to hold 2 * number_ots keys.  The
+     * receiver writes the key k_c of the i-th OT to output[i].
+     */
+    virtual void send_into(ot_key_t* output, size_t number_ots) = 0;
+    virtual void recv_into(ot_key_t* output, const std::vector<bool>& choices) = 0;
+    /**
+     * Parallelized versions of the above, using the global or the given
+     * thread pool.
+     */
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads);
+    void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads);
+    virtual void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
+    virtual void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
+
+    /**
+     * Asynchronous batch send/receive on top of the callback based
+     * Connection operations.  done is called once the keys are written to
+     * output, which has to stay valid until then.  The choices are read
+     * before these methods return.
+     *
+     * This default implementation runs send_into/recv_into and calls done
+     * before returning.
+     */
+    using done_handler_t = std::function<void(std::error_code)>;
+    virtual void async_send_into(ot_key_t* output, size_t number_ots, done_handler_t done);
+    virtual void async_recv_into(ot_key_t* output, const std::vector<bool>& choices, done_handler_t done);
+};
+
+/**
+ * 1-out-of-N random OT.
+ */
+class RandomOT_N
+{
+public:
+    virtual ~RandomOT_N() = default;
+
+    /**
+     * Number N of keys per OT.
+     */
+    virtual size_t number_messages() const = 0;
+
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     *
+     * The sender writes the keys k_0, ..., k_{N-1} of the i-th OT to
+     * output[N*i], ..., output[N*i+N-1], i.e. output has to hold
+     * N * number_ots keys.  The receiver writes the key k_c of the i-th OT to
+     * output[i], where c = choices[i] < N.
+     */
+    virtual void send_into(ot_key_t* output, size_t number_ots) = 0;
+    virtual void recv_into(ot_key_t* output, const std::vector<size_t>& choices) = 0;
+    /**
+     * Parallelized versions of the above, using the global or the given
+     * thread pool.
+     */
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads);
+    void parallel_recv_into(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads);
+    virtual void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
+    virtual void parallel_recv_into(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) = 0;
 };
 
 
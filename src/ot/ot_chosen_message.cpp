@@ -0,0 +1,130 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <stdexcept>
+#include <botan/stream_cipher.h>
+#include "ot_chosen_message.hpp"
+
+
+ChosenMessageOT::ChosenMessageOT(Connection& connection, RandomOT& random_ot)
+    : connection_(connection), random_ot_(random_ot)
+{
+}
+
+// output = input xor G(key)
+static void mask(uint8_t* output, const uint8_t* input, size_t size, const uint8_t* key)
+{
+    if (size <= sizeof(ot_key_t))
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            output[i] = input[i] ^ key[i];
+        }
+        return;
+    }
+    auto prg = Botan::StreamCipher::create_or_throw("CTR-BE(AES-128)");
+    prg->set_key(key, sizeof(ot_key_t));
+    prg->cipher(input, output, size);
+}
+
+
+void ChosenMessageOT::send(const std::vector<bytes_t>& messages)
+{
+    if (messages.size() != 2 || messages[0].size() != messages[1].size())
+        throw std::invalid_argument("ChosenMessageOT: expected two messages of equal length");
+    const auto size = messages[0].size();
+    const auto keys = random_ot_.send();
+    bytes_t masked(2 * size);
+    mask(masked.data(), messages[0].data(), size, keys.first.data());
+    mask(masked.data() + size, messages[1].data(), size, keys.second.data());
+    connection_.send_message(masked);
+}
+
+bytes_t ChosenMessageOT::recv(size_t choice)
+{
+    if (choice > 1)
+        throw std::invalid_argument("ChosenMessageOT: choice has to be 0 or 1");
+    const auto key = random_ot_.recv(choice == 1);
+    const auto masked = connection_.recv_message();
+    const auto size = masked.size() / 2;
+    bytes_t output(size);
+    mask(output.data(), masked.data() + choice * size, size, key.data());
+    return output;
+}
+
+
+void ChosenMessageOT::send(const uint8_t* messages, size_t message_size, size_t number_ots, size_t number_threads)
+{
+    if (number_ots == 0)
+        return;
+    std::vector<ot_key_t> keys(2 * number_ots);
+    if (number_threads == 1)
+        random_ot_.send_into(keys.data(), number_ots);
+    else
+        random_ot_.parallel_send_into(keys.data(), number_ots, number_threads);
+
+    // (m_0 xor G(k_0), m_1 xor G(k_1)) in chunks of whole OTs
+    const auto pair_size = 2 * message_size;
+    const auto ots_per_chunk = std::max<size_t>(1, chunk_size / pair_size);
+    bytes_t buffer(std::min(number_ots, ots_per_chunk) * pair_size);
+    for (size_t begin = 0; begin < number_ots; begin += ots_per_chunk)
+    {
+        const auto end = std::min(begin + ots_per_chunk, number_ots);
+        for (size_t i = begin; i < end; ++i)
+        {
+            for (size_t b = 0; b < 2; ++b)
+            {
+                mask(buffer.data() + (2 * (i - begin) + b) * message_size,
+                     messages + (2 * i + b) * message_size, message_size, keys[2 * i + b].data());
+            }
+        }
+        connection_.send(buffer.data(), (end - begin) * pair_size);
+    }
+}
+
+void ChosenMessageOT::recv(uint8_t* output, size_t message_size, const std::vector<bool>& choices, size_t number_threads)
+{
+    const auto number_ots = choices.size();
+    if (number_ots == 0)
+        return;
+    std::vector<ot_key_t> keys(number_ots);
+    if (number_threads == 1)
+        random_ot_.recv_into(keys.data(), choices);
+    else
+        random_ot_.parallel_recv_into(keys.data(), choices, number_threads);
+
+    // m_b = (m_b xor G(k_b)) xor G(k_b)
+    const auto pair_size = 2 * message_size;
+    const auto ots_per_chunk = std::max<size_t>(1, chunk_size / pair_size);
+    bytes_t buffer(std::min(number_ots, ots_per_chunk) * pair_size);
+    for (size_t begin = 0; begin < number_ots; begin += ots_per_chunk)
+    {
+        const auto end = std::min(begin + ots_per_chunk, number_ots);
+        connection_.recv(buffer.data(), (end - begin) * pair_size);
+        for (size_t i = begin; i < end; ++i)
+        {
+            mask(output + i * message_size, buffer.data() + (2 * (i - begin) + choices[i]) * message_size,
+                 message_size, keys[i].data());
+        }
+    }
+}
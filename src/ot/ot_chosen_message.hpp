@@ -0,0 +1,73 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OT_CHOSEN_MESSAGE_HPP
+#define OT_CHOSEN_MESSAGE_HPP
+
+#include "ot.hpp"
+#include "network/connection.hpp"
+
+
+/**
+ * 1-out-of-2 OT of chosen messages on top of any random OT.
+ *
+ * The receiver obtains k_b from the random OT for its choice b, and the
+ * sender replies with (m_0 xor G(k_0), m_1 xor G(k_1)), where G expands a
+ * key to the message length (AES-128 in counter mode for messages longer than
+ * a key).  Thus, a batch needs a single message of the sender after the
+ * random OTs, which is sent in chunks while it is computed.  random_ot has to
+ * use the same connection.
+ */
+class ChosenMessageOT : public OT
+{
+public:
+    ChosenMessageOT(Connection& connection, RandomOT& random_ot);
+
+    /**
+     * Single OT, messages has to consist of two messages of equal length.
+     */
+    void send(const std::vector<bytes_t>& messages) override;
+    bytes_t recv(size_t choice) override;
+
+    /**
+     * Batch send/receive of messages with message_size bytes each.  The
+     * sender's messages (m_0, m_1) of the i-th OT are stored at
+     * messages + 2 * i * message_size, i.e. messages holds 2 * number_ots
+     * messages.  The receiver writes m_{choices[i]} to
+     * output + i * message_size.  With more than one thread, the random OTs
+     * are computed in the global thread pool.
+     */
+    void send(const uint8_t* messages, size_t message_size, size_t number_ots, size_t number_threads=1);
+    void recv(uint8_t* output, size_t message_size, const std::vector<bool>& choices, size_t number_threads=1);
+
+    /**
+     * Size of the chunks in which the masked messages are sent.
+     */
+    static constexpr size_t chunk_size = 1 << 16;
+
+private:
+    Connection& connection_;
+    RandomOT& random_ot_;
+};
+
+
+#endif // OT_CHOSEN_MESSAGE_HPP
@@ -45,6 +45,13 @@ void OT_CO15::send_0(Sender_SharedState& state,
     // S = y*G
     curve25519::x25519_ge_scalarmult_base(&state.S, state.y);
 
+    // y*S, shared by all OTs of the batch
+    curve25519::ge_p2 y_times_S_p2;
+    curve25519::x25519_ge_scalarmult(&y_times_S_p2, state.y, &state.S);
+    curve25519::ge_p3 y_times_S_p3;
+    curve25519::x25519_ge_p2_to_p3(&y_times_S_p3, &y_times_S_p2);
+    curve25519::x25519_ge_p3_to_cached(&state.y_times_S, &y_times_S_p3);
+
     curve25519::ge_p3_tobytes(message_out.data(), &state.S);
 }
 
@@ -56,6 +63,12 @@ std::pair<bytes_t, bytes_t> OT_CO15::send_1(const Sender_SharedState& state,
     if (!x25519_ge_frombytes_vartime(&R, message_in.data()))
         std::terminate();
 
+    return send_1(state, R);
+}
+
+std::pair<bytes_t, bytes_t> OT_CO15::send_1(const Sender_SharedState& state,
+                                            const curve25519::ge_p3& R)
+{
     auto hash(Botan::Blake2b(128));
 
     auto output = std::make_pair<>(bytes_t(16), bytes_t(16));
@@ -68,9 +81,9 @@ std::pair<bytes_t, bytes_t> OT_CO15::send_1(const Sender_SharedState& state,
 
     // j = 0:
     // y*R
-    curve25519::ge_p2 a_times_R_p2;
-    curve25519::x25519_ge_scalarmult(&a_times_R_p2, state.y, &R);
-    curve25519::x25519_ge_tobytes(hash_input.data() + 64, &a_times_R_p2);
+    curve25519::ge_p2 y_times_R_p2;
+    curve25519::x25519_ge_scalarmult(&y_times_R_p2, state.y, &R);
+    curve25519::x25519_ge_tobytes(hash_input.data() + 64, &y_times_R_p2);
 
     // H(S, R, y*R)
     hash.update(hash_input.data(), hash_input.size());
@@ -78,21 +91,17 @@ std::pair<bytes_t, bytes_t> OT_CO15::send_1(const Sender_SharedState& state,
 
 
     // j = 1:
-    // y*(R - S)
+    // y*(R - S) = y*R - y*S
     {
-        curve25519::ge_cached S_cached;
-        curve25519::x25519_ge_p3_to_cached(&S_cached, &state.S);
+        curve25519::ge_p3 y_times_R_p3;
+        curve25519::x25519_ge_p2_to_p3(&y_times_R_p3, &y_times_R_p2);
 
-        curve25519::ge_p1p1 R_minus_S_p1p1;
-        curve25519::x25519_ge_sub(&R_minus_S_p1p1, &R, &S_cached);
-
-        curve25519::ge_p3 R_minus_S_p3;
-        curve25519::x25519_ge_p1p1_to_p3(&R_minus_S_p3, &R_minus_S_p1p1);
-
-        curve25519::ge_p2 y_times_R_minus_S_p2;
-        curve25519::x25519_ge_scalarmult(&y_times_R_minus_S_p2, state.y, &R_minus_S_p3);
-        curve25519::x25519_ge_tobytes(hash_input.data() + 64, &y_times_R_minus_S_p2);
+        curve25519::ge_p1p1 difference_p1p1;
+        curve25519::x25519_ge_sub(&difference_p1p1, &y_times_R_p3, &state.y_times_S);
 
+        curve25519::ge_p2 difference_p2;
+        curve25519::x25519_ge_p1p1_to_p2(&difference_p2, &difference_p1p1);
+        curve25519::x25519_ge_tobytes(hash_input.data() + 64, &difference_p2);
     }
 
     // H(S, R, y*(R - S))
@@ -125,15 +134,10 @@ void OT_CO15::recv_2(Receiver_State& state, const Receiver_SharedState& sstate,
                      std::array<uint8_t, curve25519_ge_byte_size>& message_out)
 {
     curve25519::x25519_ge_scalarmult_base(&state.R, state.x);
-    // FIXME: not constant time
-    if (state.choice == 1)
-    {
-        curve25519::ge_p1p1 R_p1p1;
-        curve25519::ge_cached S_cached;
-        curve25519::x25519_ge_p3_to_cached(&S_cached, &sstate.S);
-        curve25519::x25519_ge_add(&R_p1p1, &state.R, &S_cached);
-        curve25519::x25519_ge_p1p1_to_p3(&state.R, &R_p1p1);
-    }
+    // R = R + S if c == 1, without branching on c
+    curve25519::ge_cached S_cached;
+    curve25519::x25519_ge_p3_to_cached(&S_cached, &sstate.S);
+    curve25519::x25519_ge_add_cmov(&state.R, &state.R, &S_cached, state.choice);
 
     curve25519::ge_p3_tobytes(message_out.data(), &state.R);
 }
@@ -161,12 +165,131 @@ bytes_t OT_CO15::recv_3(const Receiver_State& state, const Receiver_SharedState&
 }
 
 
-std::vector<std::pair<bytes_t, bytes_t>> OT_CO15::send(size_t number_ots)
+// H(S, R, P)
+static void hash_points(Botan::Blake2b& hash, uint8_t* output,
+                        const uint8_t* S, const uint8_t* R, const uint8_t* P)
+{
+    hash.update(S, OT_CO15::curve25519_ge_byte_size);
+    hash.update(R, OT_CO15::curve25519_ge_byte_size);
+    hash.update(P, OT_CO15::curve25519_ge_byte_size);
+    hash.final(output);
+}
+
+void OT_CO15::send_1_batch(const Sender_SharedState& state,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                           size_t number_ots)
+{
+    // assert R in GG
+    std::vector<curve25519::ge_p3> Rs(number_ots);
+    if (!curve25519::x25519_ge_frombytes_vartime_batch(Rs.data(), messages_in->data(), number_ots))
+        std::terminate();
+
+    // y*R
+    std::vector<std::array<uint8_t, 32>> ys(number_ots);
+    for (auto& y : ys)
+    {
+        std::copy(std::begin(state.y), std::end(state.y), y.begin());
+    }
+    std::vector<curve25519::ge_p2> y_times_R(number_ots);
+    curve25519::x25519_ge_scalarmult_batch(y_times_R.data(), ys.data()->data(), Rs.data(), number_ots);
+
+    // y*(R - S) = y*R - y*S
+    std::vector<curve25519::ge_p2> points(2 * number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        points[2 * i] = y_times_R[i];
+
+        curve25519::ge_p3 y_times_R_p3;
+        curve25519::x25519_ge_p2_to_p3(&y_times_R_p3, &y_times_R[i]);
+        curve25519::ge_p1p1 difference_p1p1;
+        curve25519::x25519_ge_sub(&difference_p1p1, &y_times_R_p3, &state.y_times_S);
+        curve25519::x25519_ge_p1p1_to_p2(&points[2 * i + 1], &difference_p1p1);
+    }
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> R_bytes(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> points_bytes(2 * number_ots);
+    curve25519::ge_p3_tobytes_batch(R_bytes.data()->data(), Rs.data(), number_ots);
+    curve25519::x25519_ge_tobytes_batch(points_bytes.data()->data(), points.data(), 2 * number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        // H(S, R, y*R)
+        hash_points(hash, output[2 * i].data(), message_s0.data(),
+                    R_bytes[i].data(), points_bytes[2 * i].data());
+        // H(S, R, y*R - y*S)
+        hash_points(hash, output[2 * i + 1].data(), message_s0.data(),
+                    R_bytes[i].data(), points_bytes[2 * i + 1].data());
+    }
+}
+
+void OT_CO15::recv_2_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                           std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                           size_t number_ots)
+{
+    curve25519::ge_cached S_cached;
+    curve25519::x25519_ge_p3_to_cached(&S_cached, &sstate.S);
+
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+    }
+
+    // R = g^x
+    std::vector<curve25519::ge_p3> Rs(number_ots);
+    curve25519::x25519_ge_scalarmult_base_batch(Rs.data(), xs.data()->data(), number_ots);
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        auto& state = states[i];
+        state.R = Rs[i];
+        // R = S^c * g^x
+        curve25519::x25519_ge_add_cmov(&state.R, &state.R, &S_cached, state.choice);
+        Rs[i] = state.R;
+    }
+
+    curve25519::ge_p3_tobytes_batch(messages_out->data(), Rs.data(), number_ots);
+}
+
+void OT_CO15::recv_3_batch(const Receiver_State* states, const Receiver_SharedState& sstate,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                           size_t number_ots)
+{
+    // k_R = H_(S, R, x*S)
+
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+    }
+    std::vector<curve25519::ge_p3> Ss(number_ots, sstate.S);
+    std::vector<curve25519::ge_p2> x_times_S(number_ots);
+    curve25519::x25519_ge_scalarmult_batch(x_times_S.data(), xs.data()->data(), Ss.data(), number_ots);
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> x_times_S_bytes(number_ots);
+    curve25519::x25519_ge_tobytes_batch(x_times_S_bytes.data()->data(), x_times_S.data(), number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        hash_points(hash, output[i].data(), message_s0.data(),
+                    messages_r1[i].data(), x_times_S_bytes[i].data());
+    }
+}
+
+
+void OT_CO15::send_into(ot_key_t* output, size_t number_ots)
 {
     Sender_SharedState state;
     std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<std::pair<bytes_t, bytes_t>> output(number_ots);
 
     send_0(state, msg_s0);
 
@@ -176,25 +299,19 @@ std::vector<std::pair<bytes_t, bytes_t>> OT_CO15::send(size_t number_ots)
     auto msg_r1_size = fut_recv_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        output[i] = send_1(state, msgs_r1[i]);
-    }
+    send_1_batch(state, output, msg_s0, msgs_r1.data(), number_ots);
 
     auto msg_s0_size = fut_send_msg_s0.get();
     assert(msg_s0_size == msg_s0.size());
-
-    return output;
 }
 
-std::vector<bytes_t> OT_CO15::recv(const std::vector<bool>& choices)
+void OT_CO15::recv_into(ot_key_t* output, const std::vector<bool>& choices)
 {
     auto number_ots = choices.size();
     std::vector<Receiver_State> states(number_ots);
     Receiver_SharedState sstate;
     std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<bytes_t> output(number_ots);
 
     auto fut_recv_msg_s0 = connection_.async_recv(msg_s0.data(), msg_s0.size());
 
@@ -207,23 +324,17 @@ std::vector<bytes_t> OT_CO15::recv(const std::vector<bool>& choices)
     assert(msg_s0_size == msg_s0.size());
 
     recv_1(sstate, msg_s0);
+    // use the canonical encoding of S
+    curve25519::ge_p3_tobytes(msg_s0.data(), &sstate.S);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        recv_2(states[i], sstate, msgs_r1[i]);
-    }
+    recv_2_batch(states.data(), sstate, msgs_r1.data(), number_ots);
 
     auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        output[i] = recv_3(states[i], sstate);
-    }
+    recv_3_batch(states.data(), sstate, output, msg_s0, msgs_r1.data(), number_ots);
 
     auto msg_r1_size = fut_send_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
-
-    return output;
 }
 
 
@@ -256,12 +367,11 @@ bytes_t OT_CO15::recv(bool choice)
 }
 
 
-std::vector<std::pair<bytes_t, bytes_t>> OT_CO15::parallel_send(size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+void OT_CO15::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
 {
     Sender_SharedState sstate;
     std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<std::pair<bytes_t, bytes_t>> output(number_ots);
 
     send_0(sstate, msg_s0);
 
@@ -271,23 +381,20 @@ std::vector<std::pair<bytes_t, bytes_t>> OT_CO15::parallel_send(size_t number_ot
     auto msg_r1_size = fut_recv_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
 
-    compute(thread_pool, number_ots, number_threads, [this, &sstate, &msgs_r1, &output](size_t index){ output[index] = send_1(sstate, msgs_r1[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &sstate, &msg_s0, &msgs_r1, output](size_t begin, size_t end){ send_1_batch(sstate, output + 2 * begin, msg_s0, msgs_r1.data() + begin, end - begin); });
 
     auto msg_s0_size = fut_send_msg_s0.get();
     assert(msg_s0_size == msg_s0.size());
-
-    return output;
 }
 
 
-std::vector<bytes_t> OT_CO15::parallel_recv(const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+void OT_CO15::parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
 {
     auto number_ots = choices.size();
     std::vector<Receiver_State> states(number_ots);
     Receiver_SharedState sstate;
     std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<bytes_t> output(number_ots);
 
     auto fut_recv_msg_s0 = connection_.async_recv(msg_s0.data(), msg_s0.size());
 
@@ -297,15 +404,15 @@ std::vector<bytes_t> OT_CO15::parallel_recv(const std::vector<bool>& choices, si
     assert(msg_s0_size == msg_s0.size());
 
     recv_1(sstate, msg_s0);
+    // use the canonical encoding of S
+    curve25519::ge_p3_tobytes(msg_s0.data(), &sstate.S);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &sstate, &msgs_r1](size_t index){ recv_2(states[index], sstate, msgs_r1[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &sstate, &msgs_r1](size_t begin, size_t end){ recv_2_batch(states.data() + begin, sstate, msgs_r1.data() + begin, end - begin); });
 
     auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &sstate, &output](size_t index){ output[index] = recv_3(states[index], sstate); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &sstate, output, &msg_s0, &msgs_r1](size_t begin, size_t end){ recv_3_batch(states.data() + begin, sstate, output + begin, msg_s0, msgs_r1.data() + begin, end - begin); });
 
     auto msg_r1_size = fut_send_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
-
-    return output;
 }
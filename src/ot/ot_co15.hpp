@@ -23,6 +23,7 @@
 #ifndef OT_CO15_HPP
 #define OT_CO15_HPP
 
+#include <array>
 #include "ot.hpp"
 #include "network/connection.hpp"
 #include "curve25519/mycurve25519.h"
@@ -47,20 +48,23 @@ public:
     /**
      * Send/receive parts of the random OT protocol (batch version).
      */
-    std::vector<std::pair<bytes_t, bytes_t>> send(size_t) override;
-    std::vector<bytes_t> recv(const std::vector<bool>&) override;
-    /**
-     * Parallelized version of batch send/receive.
-     * These methods will create a new thread pool.
-     */
+    using RandomOT::send;
+    using RandomOT::recv;
     using RandomOT::parallel_send;
     using RandomOT::parallel_recv;
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     */
+    void send_into(ot_key_t* output, size_t number_ots) override;
+    void recv_into(ot_key_t* output, const std::vector<bool>& choices) override;
     /**
      * Parallelized version of batch send/receive.
      * These methods will use the given thread pool.
      */
-    std::vector<std::pair<bytes_t, bytes_t>> parallel_send(size_t, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
-    std::vector<bytes_t> parallel_recv(const std::vector<bool>&, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    using RandomOT::parallel_send_into;
+    using RandomOT::parallel_recv_into;
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
 private:
 
     Connection& connection_;
@@ -72,6 +76,8 @@ public: // for testing
         uint8_t y[32];
         // S
         curve25519::ge_p3 S;
+        // y*S
+        curve25519::ge_cached y_times_S;
     };
     struct Receiver_SharedState
     {
@@ -95,6 +101,11 @@ public: // for testing
                 std::array<uint8_t, curve25519_ge_byte_size>& message_out);
     std::pair<bytes_t, bytes_t> send_1(const Sender_SharedState& state,
                                        const std::array<uint8_t, curve25519_ge_byte_size>& message_in);
+    /**
+     * Variant of send_1 for an already decoded (and validated) point R.
+     */
+    std::pair<bytes_t, bytes_t> send_1(const Sender_SharedState& state,
+                                       const curve25519::ge_p3& R);
 
     /**
      * Parts of the receiver side.
@@ -105,6 +116,26 @@ public: // for testing
     void recv_2(Receiver_State& state, const Receiver_SharedState& sstate,
                 std::array<uint8_t, curve25519_ge_byte_size>& message_out);
     bytes_t recv_3(const Receiver_State& state, const Receiver_SharedState& sstate);
+
+    /**
+     * Batch versions of the parts above for number_ots OTs.  The point
+     * encodings of a batch share their field inversions.  message_s0 is the
+     * encoding of S.  The keys are written to output as in
+     * RandomOT::send_into/recv_into.
+     */
+    void send_1_batch(const Sender_SharedState& state,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                      size_t number_ots);
+    void recv_2_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                      std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                      size_t number_ots);
+    void recv_3_batch(const Receiver_State* states, const Receiver_SharedState& sstate,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                      size_t number_ots);
 };
 
 
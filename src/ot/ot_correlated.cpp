@@ -0,0 +1,87 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include "ot_correlated.hpp"
+
+
+CorrelatedOT::CorrelatedOT(Connection& connection, RandomOT& random_ot)
+    : connection_(connection), random_ot_(random_ot), delta_()
+{
+    auto delta_bytes = random_bytes(delta_.size());
+    std::copy(delta_bytes.cbegin(), delta_bytes.cend(), delta_.begin());
+}
+
+void CorrelatedOT::send(ot_key_t* output, size_t number_ots, size_t number_threads)
+{
+    if (number_ots == 0)
+        return;
+    std::vector<ot_key_t> keys(2 * number_ots);
+    if (number_threads == 1)
+        random_ot_.send_into(keys.data(), number_ots);
+    else
+        random_ot_.parallel_send_into(keys.data(), number_ots, number_threads);
+
+    // x_i = k_0, send k_0 xor k_1 xor delta
+    std::vector<ot_key_t> buffer(std::min(number_ots, chunk_size));
+    for (size_t begin = 0; begin < number_ots; begin += chunk_size)
+    {
+        const auto end = std::min(begin + chunk_size, number_ots);
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& y = buffer[i - begin];
+            for (size_t k = 0; k < y.size(); ++k)
+            {
+                y[k] = keys[2 * i][k] ^ keys[2 * i + 1][k] ^ delta_[k];
+            }
+            output[i] = keys[2 * i];
+        }
+        connection_.send(buffer.data()->data(), (end - begin) * sizeof(ot_key_t));
+    }
+}
+
+void CorrelatedOT::recv(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads)
+{
+    const auto number_ots = choices.size();
+    if (number_ots == 0)
+        return;
+    if (number_threads == 1)
+        random_ot_.recv_into(output, choices);
+    else
+        random_ot_.parallel_recv_into(output, choices, number_threads);
+
+    // k_b xor b * (k_0 xor k_1 xor delta) = k_0 xor b * delta
+    std::vector<ot_key_t> buffer(std::min(number_ots, chunk_size));
+    for (size_t begin = 0; begin < number_ots; begin += chunk_size)
+    {
+        const auto end = std::min(begin + chunk_size, number_ots);
+        connection_.recv(buffer.data()->data(), (end - begin) * sizeof(ot_key_t));
+        for (size_t i = begin; i < end; ++i)
+        {
+            const auto mask = static_cast<uint8_t>(0 - static_cast<uint8_t>(choices[i]));
+            for (size_t k = 0; k < output[i].size(); ++k)
+            {
+                output[i][k] ^= buffer[i - begin][k] & mask;
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OT_CORRELATED_HPP
+#define OT_CORRELATED_HPP
+
+#include "ot.hpp"
+#include "network/connection.hpp"
+
+
+/**
+ * Correlated OT with a global offset delta on top of any random OT.
+ *
+ * The sender obtains random x_i and the receiver x_i xor b_i * delta for its
+ * choices b_i.  With the random OT keys (k_0, k_1), the sender sets x_i = k_0
+ * and sends k_0 xor k_1 xor delta, from which the receiver with k_b computes
+ * its output.  Thus, a batch needs a single message of 16 bytes per OT after
+ * the random OTs.  random_ot has to use the same connection.
+ */
+class CorrelatedOT
+{
+public:
+    /**
+     * The sender's delta is chosen at random.
+     */
+    CorrelatedOT(Connection& connection, RandomOT& random_ot);
+
+    const ot_key_t& delta() const { return delta_; }
+    void set_delta(const ot_key_t& delta) { delta_ = delta; }
+
+    /**
+     * Batch send/receive.  With more than one thread, the random OTs are
+     * computed in the global thread pool.
+     */
+    void send(ot_key_t* output, size_t number_ots, size_t number_threads=1);
+    void recv(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads=1);
+
+    /**
+     * Number of OTs whose messages are sent together.
+     */
+    static constexpr size_t chunk_size = 1 << 12;
+
+private:
+    Connection& connection_;
+    RandomOT& random_ot_;
+    ot_key_t delta_;
+};
+
+
+#endif // OT_CORRELATED_HPP
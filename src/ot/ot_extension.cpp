@@ -0,0 +1,275 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+#include <stdexcept>
+#include <boost/asio.hpp>
+#include <botan/blake2b.h>
+#include <botan/stream_cipher.h>
+#include "ot_extension.hpp"
+#include "util/bit_matrix.hpp"
+#include "util/gf128.hpp"
+#include "util/threading.hpp"
+
+using iknp::get_bit;
+using iknp::hash_row;
+using iknp::make_prg;
+using iknp::pad_number_ots;
+
+
+OTExtension::OTExtension(Connection& connection, RandomOT& base_ot, bool active_security)
+    : connection_(connection), active_security_(active_security),
+      sender_(base_ot, security_parameter), sender_counter_(0),
+      receiver_(base_ot, security_parameter), receiver_counter_(0)
+{
+}
+
+OTExtension::~OTExtension() = default;
+
+// Notation: see iknp.hpp with k = security_parameter and
+// * random oracle H: N x {0,1}^k -> {0,1}^k
+//
+// Correlation check (only with active security):
+// * the receiver appends check_rows OTs with random choices
+// * after receiving U, the sender sends a fresh seed, chi_j is the j-th block
+//   of G(seed)
+// * the receiver sends x = sum_j r_j * chi_j and t = sum_j t_j * chi_j
+// * the sender checks that t = sum_j q_j * chi_j + x * s in GF(2^128)
+
+
+// Compute row_sum = sum_j rows[j] * chi_j and, if bits is not nullptr,
+// bit_sum = sum_j bit j of bits * chi_j for j in [0, number_rows).
+static void combine_rows(uint8_t* row_sum, uint8_t* bit_sum, const ot_key_t& seed,
+                         const ot_key_t* rows, const uint8_t* bits, size_t number_rows,
+                         boost::asio::thread_pool* thread_pool, size_t number_threads)
+{
+    std::mutex mutex;
+    gf128_sum_t total_row_sum{};
+    ot_key_t total_bit_sum{};
+    for_each_interval(thread_pool, number_threads, number_rows,
+        [&mutex, &total_row_sum, &total_bit_sum, &seed, rows, bits](size_t begin, size_t end)
+        {
+            const size_t chunk_size = 1024;
+            std::vector<ot_key_t> chi(std::min(chunk_size, end - begin));
+            gf128_sum_t local_row_sum{};
+            ot_key_t local_bit_sum{};
+
+            // the counter of G starts at block begin
+            auto prg = make_prg(seed);
+            ot_key_t iv{};
+            for (size_t k = 0; k < 8; ++k)
+            {
+                iv[iv.size() - 1 - k] = static_cast<uint8_t>(static_cast<uint64_t>(begin) >> (8 * k));
+            }
+            prg->set_iv(iv.data(), iv.size());
+
+            for (size_t c = begin; c < end; c += chunk_size)
+            {
+                const auto n = std::min(chunk_size, end - c);
+                std::fill(chi.data()->data(), chi.data()->data() + n * sizeof(ot_key_t), 0);
+                prg->cipher1(chi.data()->data(), n * sizeof(ot_key_t));
+                gf128_mul_add(local_row_sum, rows[c].data(), chi.data()->data(), n);
+                if (bits == nullptr)
+                    continue;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    const auto mask = static_cast<uint8_t>(0 - get_bit(bits, c + j));
+                    for (size_t k = 0; k < local_bit_sum.size(); ++k)
+                    {
+                        local_bit_sum[k] ^= chi[j][k] & mask;
+                    }
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t k = 0; k < total_row_sum.size(); ++k)
+            {
+                total_row_sum[k] ^= local_row_sum[k];
+            }
+            for (size_t k = 0; k < total_bit_sum.size(); ++k)
+            {
+                total_bit_sum[k] ^= local_bit_sum[k];
+            }
+        });
+    gf128_reduce(row_sum, total_row_sum);
+    if (bits != nullptr)
+        std::copy(total_bit_sum.cbegin(), total_bit_sum.cend(), bit_sum);
+}
+
+
+void OTExtension::send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    if (!sender_.ready())
+        sender_.setup(number_threads, thread_pool);
+
+    const auto number_rows = pad_number_ots(active_security_ ? number_ots + check_rows : number_ots);
+    const auto column_size = number_rows / 8;
+
+    // recv U
+    bytes_t matrix(security_parameter * column_size);
+    connection_.recv(matrix.data(), matrix.size());
+
+    // q^i = G(k_i^{s_i}) xor s_i * u^i
+    //     = t^i xor s_i * r
+    sender_.compute_q(matrix.data(), column_size, number_threads, thread_pool);
+
+    // q_j = t_j xor r_j * s
+    std::vector<block_t> rows(number_rows);
+    transpose_bit_matrix(reinterpret_cast<uint8_t*>(rows.data()), matrix.data(),
+                         security_parameter, number_rows);
+
+    if (active_security_)
+    {
+        block_t seed;
+        auto seed_bytes = random_bytes(seed.size());
+        std::copy(seed_bytes.cbegin(), seed_bytes.cend(), seed.begin());
+        connection_.send(seed.data(), seed.size());
+
+        // q = sum_j q_j * chi_j
+        block_t q;
+        combine_rows(q.data(), nullptr, seed, rows.data(), nullptr, number_rows, thread_pool, number_threads);
+
+        // recv (x, t)
+        std::array<uint8_t, 2 * key_size> response;
+        connection_.recv(response.data(), response.size());
+
+        // t = q xor x * s
+        block_t x_s;
+        gf128_mul(x_s.data(), response.data(), sender_.s());
+        std::transform(q.cbegin(), q.cend(), x_s.cbegin(), q.begin(),
+                       [](auto a, auto b) { return a ^ b; });
+        if (!std::equal(q.cbegin(), q.cend(), response.cbegin() + key_size))
+            throw std::runtime_error("OTExtension: correlation check failed");
+    }
+
+    // (H(j, q_j), H(j, q_j xor s))
+    for_each_interval(thread_pool, number_threads, number_ots,
+        [this, &rows, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            block_t row_xor_s;
+            for (size_t j = begin; j < end; ++j)
+            {
+                hash_row(hash, output[2 * j].data(), sender_counter_ + j, rows[j].data(), rows[j].size());
+                std::transform(rows[j].cbegin(), rows[j].cend(), sender_.s(), row_xor_s.begin(),
+                               [](auto a, auto b) { return a ^ b; });
+                hash_row(hash, output[2 * j + 1].data(), sender_counter_ + j, row_xor_s.data(), row_xor_s.size());
+            }
+        });
+
+    sender_counter_ += number_ots;
+}
+
+void OTExtension::recv_impl(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    if (!receiver_.ready())
+        receiver_.setup(number_threads, thread_pool);
+
+    const auto number_ots = choices.size();
+    const auto number_rows = pad_number_ots(active_security_ ? number_ots + check_rows : number_ots);
+    const auto column_size = number_rows / 8;
+
+    // r = choices (followed by random choices for the check)
+    bytes_t r(active_security_ ? random_bytes(column_size) : bytes_t(column_size));
+    for (size_t j = 0; j < number_ots; ++j)
+    {
+        r[j / 8] &= static_cast<uint8_t>(~(1 << (j % 8)));
+        r[j / 8] |= static_cast<uint8_t>(choices[j] << (j % 8));
+    }
+
+    // t^i = G(k_i^0)
+    // u^i = t^i xor G(k_i^1) xor r
+    bytes_t matrix_t(security_parameter * column_size);
+    bytes_t matrix_u(security_parameter * column_size);
+    for (size_t i = 0; i < security_parameter; ++i)
+    {
+        std::copy(r.cbegin(), r.cend(), matrix_u.begin() + i * column_size);
+    }
+    receiver_.compute_t_u(matrix_t.data(), matrix_u.data(), column_size, number_threads, thread_pool);
+
+    auto fut_send_u = connection_.async_send(matrix_u.data(), matrix_u.size());
+
+    std::vector<block_t> rows(number_rows);
+    transpose_bit_matrix(reinterpret_cast<uint8_t*>(rows.data()), matrix_t.data(),
+                         security_parameter, number_rows);
+
+    // H(j, t_j)
+    for_each_interval(thread_pool, number_threads, number_ots,
+        [this, &rows, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            for (size_t j = begin; j < end; ++j)
+            {
+                hash_row(hash, output[j].data(), receiver_counter_ + j, rows[j].data(), rows[j].size());
+            }
+        });
+
+    auto u_size = fut_send_u.get();
+    assert(u_size == matrix_u.size());
+
+    if (active_security_)
+    {
+        block_t seed;
+        connection_.recv(seed.data(), seed.size());
+
+        // x = sum_j r_j * chi_j, t = sum_j t_j * chi_j
+        std::array<uint8_t, 2 * key_size> response;
+        combine_rows(response.data() + key_size, response.data(), seed, rows.data(), r.data(), number_rows,
+                     thread_pool, number_threads);
+        connection_.send(response.data(), response.size());
+    }
+
+    receiver_counter_ += number_ots;
+}
+
+
+std::pair<bytes_t, bytes_t> OTExtension::send()
+{
+    return send(1).front();
+}
+
+bytes_t OTExtension::recv(bool choice)
+{
+    return recv(std::vector<bool>{choice}).front();
+}
+
+void OTExtension::send_into(ot_key_t* output, size_t number_ots)
+{
+    send_impl(output, number_ots, 1, nullptr);
+}
+
+void OTExtension::recv_into(ot_key_t* output, const std::vector<bool>& choices)
+{
+    recv_impl(output, choices, 1, nullptr);
+}
+
+void OTExtension::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    send_impl(output, number_ots, number_threads, &thread_pool);
+}
+
+void OTExtension::parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    recv_impl(output, choices, number_threads, &thread_pool);
+}
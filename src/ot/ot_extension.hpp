@@ -0,0 +1,110 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OT_EXTENSION_HPP
+#define OT_EXTENSION_HPP
+
+#include <array>
+#include <memory>
+#include "ot.hpp"
+#include "iknp.hpp"
+#include "network/connection.hpp"
+
+
+/**
+ * A random OT extension based on the protocol by Ishai, Kilian, Nissim, and
+ * Petrank (2003).
+ * https://www.iacr.org/archive/crypto2003/27290145/27290145.pdf
+ *
+ * The 128 base OTs are obtained from another random OT implementation (e.g.
+ * OT_HL17 or OT_CO15) which has to use the same connection.  They are
+ * performed on the first call of send or recv, respectively.  Afterwards, only
+ * symmetric cryptography is used.
+ *
+ * With active_security, the correlation check of Keller, Orsini, and Scholl
+ * (2015) https://eprint.iacr.org/2015/546 protects the sender against a
+ * malicious receiver: every batch is extended by check_rows random OTs, and
+ * the receiver has to prove that it used consistent choice bits by opening a
+ * random linear combination of the rows in GF(2^128).  If the check fails,
+ * send throws a std::runtime_error.
+ */
+class OTExtension : public RandomOT
+{
+public:
+    OTExtension(Connection& connection, RandomOT& base_ot, bool active_security=false);
+    ~OTExtension();
+
+    /**
+     * Send/receive for a single random OT.
+     */
+    std::pair<bytes_t, bytes_t> send() override;
+    bytes_t recv(bool) override;
+
+    /**
+     * Send/receive parts of the random OT protocol (batch version).
+     */
+    using RandomOT::send;
+    using RandomOT::recv;
+    using RandomOT::parallel_send;
+    using RandomOT::parallel_recv;
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     */
+    void send_into(ot_key_t* output, size_t number_ots) override;
+    void recv_into(ot_key_t* output, const std::vector<bool>& choices) override;
+    /**
+     * Parallelized version of batch send/receive.
+     * These methods will use the given thread pool.
+     */
+    using RandomOT::parallel_send_into;
+    using RandomOT::parallel_recv_into;
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+
+    static constexpr size_t security_parameter = 128;
+    static constexpr size_t key_size = 16;
+    static constexpr size_t statistical_security_parameter = 64;
+    static constexpr size_t check_rows = security_parameter + statistical_security_parameter;
+
+private:
+    using block_t = ot_key_t;
+    static_assert(sizeof(block_t) == security_parameter / 8);
+
+    /**
+     * Implementation of the batch send/receive.  If thread_pool is nullptr
+     * everything is computed in the calling thread.
+     */
+    void send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    void recv_impl(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+    Connection& connection_;
+    const bool active_security_;
+
+    iknp::Sender sender_;
+    uint64_t sender_counter_;
+
+    iknp::Receiver receiver_;
+    uint64_t receiver_counter_;
+};
+
+
+#endif // OT_EXTENSION_HPP
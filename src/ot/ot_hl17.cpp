@@ -22,8 +22,17 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
 #include <boost/asio.hpp>
 #include <botan/blake2b.h>
 #include <botan/hex.h>
@@ -31,10 +40,16 @@
 #include "util/threading.hpp"
 
 
-OT_HL17::OT_HL17(Connection& connection) : connection_(connection)
+OT_HL17::OT_HL17(Connection& connection, bool shared_state)
+    : connection_(connection), shared_state_(shared_state), chunk_size_(0)
 {
 }
 
+void OT_HL17::set_chunk_size(size_t chunk_size)
+{
+    chunk_size_ = chunk_size;
+}
+
 // Notation
 // * Group GG
 // * of prime order p
@@ -46,12 +61,18 @@ OT_HL17::OT_HL17(Connection& connection) : connection_(connection)
 
 void OT_HL17::hash_point(curve25519::ge_p3& output, const curve25519::ge_p3& input)
 {
-    std::array<uint8_t, 32> hash_input;
+    std::array<uint8_t, curve25519_ge_byte_size> hash_input;
+    curve25519::ge_p3_tobytes(hash_input.data(), &input);
+    hash_point(output, hash_input);
+}
+
+void OT_HL17::hash_point(curve25519::ge_p3& output,
+                         const std::array<uint8_t, curve25519_ge_byte_size>& input)
+{
     std::array<uint8_t, 64> hash_output{};
     auto hash(Botan::Blake2b(256));
 
-    curve25519::ge_p3_tobytes(hash_input.data(), &input);
-    hash.update(hash_input.data(), hash_input.size());
+    hash.update(input.data(), input.size());
     hash.final(hash_output.data());
     curve25519::x25519_sc_reduce(hash_output.data());
 
@@ -79,10 +100,19 @@ void OT_HL17::send_1(Sender_State& state)
 std::pair<bytes_t, bytes_t> OT_HL17::send_2(Sender_State& state,
                                             const std::array<uint8_t, curve25519_ge_byte_size>& message_in)
 {
+    curve25519::ge_p3 R;
     // // assert R in GG
-    if (!x25519_ge_frombytes_vartime(&state.R, message_in.data()))
+    if (!x25519_ge_frombytes_vartime(&R, message_in.data()))
         std::terminate();
 
+    return send_2(state, R);
+}
+
+std::pair<bytes_t, bytes_t> OT_HL17::send_2(Sender_State& state,
+                                            const curve25519::ge_p3& R)
+{
+    state.R = R;
+
     auto hash(Botan::Blake2b(128));
 
     auto output = std::make_pair<>(bytes_t(16), bytes_t(16));
@@ -155,15 +185,10 @@ void OT_HL17::recv_1(Receiver_State& state,
     // R = g^x
     curve25519::x25519_ge_scalarmult_base(&state.R, state.x);
 
-    // FIXME: not constant time
-    if (state.choice == 1)
-    {
-        curve25519::ge_p1p1 R_p1p1;
-        curve25519::ge_cached T_cached;
-        curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
-        curve25519::x25519_ge_add(&R_p1p1, &state.R, &T_cached);
-        curve25519::x25519_ge_p1p1_to_p3(&state.R, &R_p1p1);
-    }
+    // R = R + T if c == 1, without branching on c
+    curve25519::ge_cached T_cached;
+    curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
+    curve25519::x25519_ge_add_cmov(&state.R, &state.R, &T_cached, state.choice);
 
     bytes_t R_bytes(32);
     curve25519::ge_p3_tobytes(message_out.data(), &state.R);
@@ -195,6 +220,323 @@ bytes_t OT_HL17::recv_2(Receiver_State& state)
 }
 
 
+// H(S, R, P)
+static void hash_points(Botan::Blake2b& hash, uint8_t* output,
+                        const uint8_t* S, const uint8_t* R, const uint8_t* P)
+{
+    hash.update(S, OT_HL17::curve25519_ge_byte_size);
+    hash.update(R, OT_HL17::curve25519_ge_byte_size);
+    hash.update(P, OT_HL17::curve25519_ge_byte_size);
+    hash.final(output);
+}
+
+void OT_HL17::send_0_batch(Sender_State* states,
+                           std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                           size_t number_ots)
+{
+    std::vector<std::array<uint8_t, 32>> ys(number_ots);
+    std::vector<curve25519::ge_p3> Ss(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        // sample y <- Zp
+        curve25519::sc_random(ys[i].data());
+    }
+    // S = g^y
+    curve25519::x25519_ge_scalarmult_base_batch(Ss.data(), ys.data()->data(), number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(ys[i].begin(), ys[i].end(), states[i].y);
+        states[i].S = Ss[i];
+    }
+    curve25519::ge_p3_tobytes_batch(messages_out->data(), Ss.data(), number_ots);
+}
+
+void OT_HL17::send_1_batch(Sender_State* states,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_s0,
+                           size_t number_ots)
+{
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        // T = G(S)
+        hash_point(states[i].T, messages_s0[i]);
+    }
+}
+
+void OT_HL17::send_2_batch(Sender_State* states,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_s0,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                           size_t number_ots)
+{
+    // assert R in GG
+    std::vector<curve25519::ge_p3> Rs(number_ots);
+    if (!curve25519::x25519_ge_frombytes_vartime_batch(Rs.data(), messages_in->data(), number_ots))
+        std::terminate();
+
+    // y*R and y*(R - T)
+    std::vector<std::array<uint8_t, 32>> scalars(2 * number_ots);
+    std::vector<curve25519::ge_p3> bases(2 * number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        auto& state = states[i];
+        state.R = Rs[i];
+
+        std::copy(std::begin(state.y), std::end(state.y), scalars[2 * i].begin());
+        std::copy(std::begin(state.y), std::end(state.y), scalars[2 * i + 1].begin());
+        bases[2 * i] = state.R;
+
+        curve25519::ge_cached T_cached;
+        curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
+
+        curve25519::ge_p1p1 R_minus_T_p1p1;
+        curve25519::x25519_ge_sub(&R_minus_T_p1p1, &state.R, &T_cached);
+        curve25519::x25519_ge_p1p1_to_p3(&bases[2 * i + 1], &R_minus_T_p1p1);
+    }
+    std::vector<curve25519::ge_p2> points(2 * number_ots);
+    curve25519::x25519_ge_scalarmult_batch(points.data(), scalars.data()->data(), bases.data(), 2 * number_ots);
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> R_bytes(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> points_bytes(2 * number_ots);
+    curve25519::ge_p3_tobytes_batch(R_bytes.data()->data(), Rs.data(), number_ots);
+    curve25519::x25519_ge_tobytes_batch(points_bytes.data()->data(), points.data(), 2 * number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        // H(S, R, y*R)
+        hash_points(hash, output[2 * i].data(), messages_s0[i].data(),
+                    R_bytes[i].data(), points_bytes[2 * i].data());
+        // H(S, R, y*R - y*T)
+        hash_points(hash, output[2 * i + 1].data(), messages_s0[i].data(),
+                    R_bytes[i].data(), points_bytes[2 * i + 1].data());
+    }
+}
+
+void OT_HL17::recv_1_batch(Receiver_State* states,
+                           std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                           std::array<uint8_t, curve25519_ge_byte_size>* S_bytes,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                           size_t number_ots)
+{
+    // recv S
+    std::vector<curve25519::ge_p3> points(number_ots);
+    // assert S in GG
+    if (!curve25519::x25519_ge_frombytes_vartime_batch(points.data(), messages_in->data(), number_ots))
+        std::terminate();
+    curve25519::ge_p3_tobytes_batch(S_bytes->data(), points.data(), number_ots);
+
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        states[i].S = points[i];
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+    }
+
+    // R = g^x
+    curve25519::x25519_ge_scalarmult_base_batch(points.data(), xs.data()->data(), number_ots);
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        auto& state = states[i];
+        state.R = points[i];
+
+        // T = G(S)
+        hash_point(state.T, S_bytes[i]);
+
+        // R = T^c * g^x
+        curve25519::ge_cached T_cached;
+        curve25519::x25519_ge_p3_to_cached(&T_cached, &state.T);
+        curve25519::x25519_ge_add_cmov(&state.R, &state.R, &T_cached, state.choice);
+        points[i] = state.R;
+    }
+
+    curve25519::ge_p3_tobytes_batch(messages_out->data(), points.data(), number_ots);
+}
+
+void OT_HL17::recv_2_batch(Receiver_State* states,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* S_bytes,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                           size_t number_ots)
+{
+    // k_R = H_(S,R)(S^x)
+    //     = H_(S,R)(g^xy)
+
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    std::vector<curve25519::ge_p3> Ss(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+        Ss[i] = states[i].S;
+    }
+    std::vector<curve25519::ge_p2> S_to_the_x(number_ots);
+    curve25519::x25519_ge_scalarmult_batch(S_to_the_x.data(), xs.data()->data(), Ss.data(), number_ots);
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> S_to_the_x_bytes(number_ots);
+    curve25519::x25519_ge_tobytes_batch(S_to_the_x_bytes.data()->data(), S_to_the_x.data(), number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        hash_points(hash, output[i].data(), S_bytes[i].data(),
+                    messages_r1[i].data(), S_to_the_x_bytes[i].data());
+    }
+}
+
+
+void OT_HL17::send_0(Sender_SharedState& sstate,
+                     std::array<uint8_t, curve25519_ge_byte_size>& message_out)
+{
+    // sample y <- Zp
+    curve25519::sc_random(sstate.y);
+
+    // S = g^y
+    curve25519::x25519_ge_scalarmult_base(&sstate.S, sstate.y);
+
+    curve25519::ge_p3_tobytes(message_out.data(), &sstate.S);
+}
+
+void OT_HL17::send_1(Sender_SharedState& sstate,
+                     const std::array<uint8_t, curve25519_ge_byte_size>& message_s0)
+{
+    // T = G(S)
+    hash_point(sstate.T, message_s0);
+
+    // y*T
+    curve25519::ge_p2 y_times_T_p2;
+    curve25519::x25519_ge_scalarmult(&y_times_T_p2, sstate.y, &sstate.T);
+    curve25519::ge_p3 y_times_T_p3;
+    curve25519::x25519_ge_p2_to_p3(&y_times_T_p3, &y_times_T_p2);
+    curve25519::x25519_ge_p3_to_cached(&sstate.y_times_T, &y_times_T_p3);
+}
+
+void OT_HL17::send_2_batch(const Sender_SharedState& sstate,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                           size_t number_ots)
+{
+    // assert R in GG
+    std::vector<curve25519::ge_p3> Rs(number_ots);
+    if (!curve25519::x25519_ge_frombytes_vartime_batch(Rs.data(), messages_in->data(), number_ots))
+        std::terminate();
+
+    // y*R
+    std::vector<std::array<uint8_t, 32>> ys(number_ots);
+    for (auto& y : ys)
+    {
+        std::copy(std::begin(sstate.y), std::end(sstate.y), y.begin());
+    }
+    std::vector<curve25519::ge_p2> y_times_R(number_ots);
+    curve25519::x25519_ge_scalarmult_batch(y_times_R.data(), ys.data()->data(), Rs.data(), number_ots);
+
+    // y*(R - T) = y*R - y*T
+    std::vector<curve25519::ge_p2> points(2 * number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        points[2 * i] = y_times_R[i];
+
+        curve25519::ge_p3 y_times_R_p3;
+        curve25519::x25519_ge_p2_to_p3(&y_times_R_p3, &y_times_R[i]);
+        curve25519::ge_p1p1 difference_p1p1;
+        curve25519::x25519_ge_sub(&difference_p1p1, &y_times_R_p3, &sstate.y_times_T);
+        curve25519::x25519_ge_p1p1_to_p2(&points[2 * i + 1], &difference_p1p1);
+    }
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> R_bytes(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> points_bytes(2 * number_ots);
+    curve25519::ge_p3_tobytes_batch(R_bytes.data()->data(), Rs.data(), number_ots);
+    curve25519::x25519_ge_tobytes_batch(points_bytes.data()->data(), points.data(), 2 * number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        // H(S, R, y*R)
+        hash_points(hash, output[2 * i].data(), message_s0.data(),
+                    R_bytes[i].data(), points_bytes[2 * i].data());
+        // H(S, R, y*R - y*T)
+        hash_points(hash, output[2 * i + 1].data(), message_s0.data(),
+                    R_bytes[i].data(), points_bytes[2 * i + 1].data());
+    }
+}
+
+void OT_HL17::recv_1(Receiver_SharedState& sstate,
+                     std::array<uint8_t, curve25519_ge_byte_size>& S_bytes,
+                     const std::array<uint8_t, curve25519_ge_byte_size>& message_in)
+{
+    // recv S
+    // assert S in GG
+    if (!curve25519::x25519_ge_frombytes_vartime(&sstate.S, message_in.data()))
+        std::terminate();
+    // use the canonical encoding of S
+    curve25519::ge_p3_tobytes(S_bytes.data(), &sstate.S);
+
+    // T = G(S)
+    curve25519::ge_p3 T;
+    hash_point(T, S_bytes);
+    curve25519::x25519_ge_p3_to_cached(&sstate.T, &T);
+}
+
+void OT_HL17::recv_1_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                           std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                           size_t number_ots)
+{
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+    }
+
+    // R = g^x
+    std::vector<curve25519::ge_p3> Rs(number_ots);
+    curve25519::x25519_ge_scalarmult_base_batch(Rs.data(), xs.data()->data(), number_ots);
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        auto& state = states[i];
+        state.R = Rs[i];
+        // R = T^c * g^x
+        curve25519::x25519_ge_add_cmov(&state.R, &state.R, &sstate.T, state.choice);
+        Rs[i] = state.R;
+    }
+
+    curve25519::ge_p3_tobytes_batch(messages_out->data(), Rs.data(), number_ots);
+}
+
+void OT_HL17::recv_2_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                           ot_key_t* output,
+                           const std::array<uint8_t, curve25519_ge_byte_size>& S_bytes,
+                           const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                           size_t number_ots)
+{
+    // k_R = H_(S,R)(S^x)
+    //     = H_(S,R)(g^xy)
+
+    std::vector<std::array<uint8_t, 32>> xs(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        std::copy(std::begin(states[i].x), std::end(states[i].x), xs[i].begin());
+    }
+    std::vector<curve25519::ge_p3> Ss(number_ots, sstate.S);
+    std::vector<curve25519::ge_p2> S_to_the_x(number_ots);
+    curve25519::x25519_ge_scalarmult_batch(S_to_the_x.data(), xs.data()->data(), Ss.data(), number_ots);
+
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> S_to_the_x_bytes(number_ots);
+    curve25519::x25519_ge_tobytes_batch(S_to_the_x_bytes.data()->data(), S_to_the_x.data(), number_ots);
+
+    auto hash(Botan::Blake2b(128));
+    assert(sizeof(ot_key_t) == hash.output_length());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        hash_points(hash, output[i].data(), S_bytes.data(),
+                    messages_r1[i].data(), S_to_the_x_bytes[i].data());
+    }
+}
+
+
 std::pair<bytes_t, bytes_t> OT_HL17::send()
 {
     Sender_State state;
@@ -223,47 +565,57 @@ bytes_t OT_HL17::recv(bool choice)
 }
 
 
-std::vector<std::pair<bytes_t, bytes_t>> OT_HL17::send(size_t number_ots)
+void OT_HL17::send_into(ot_key_t* output, size_t number_ots)
 {
+    if (chunk_size_ > 0 && number_ots > 0)
+    {
+        send_pipelined(output, number_ots, 1, nullptr);
+        return;
+    }
+    if (shared_state_)
+    {
+        send_shared(output, number_ots);
+        return;
+    }
+
     std::vector<Sender_State> states(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<std::pair<bytes_t, bytes_t>> output(number_ots);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        send_0(states[i], msgs_s0[i]);
-    }
+    send_0_batch(states.data(), msgs_s0.data(), number_ots);
 
     auto fut_send_msg_s0 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_s0.data()), msgs_s0.size() * curve25519_ge_byte_size);
     auto fut_recv_msg_r1 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        send_1(states[i]);
-    }
+    send_1_batch(states.data(), msgs_s0.data(), number_ots);
 
     auto msg_r1_size = fut_recv_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
 
-    for (size_t i = 0; i < number_ots; ++i)
-    {
-        output[i] = send_2(states[i], msgs_r1[i]);
-    }
+    send_2_batch(states.data(), output, msgs_s0.data(), msgs_r1.data(), number_ots);
 
     auto msg_s0_size = fut_send_msg_s0.get();
     assert(msg_s0_size == msgs_s0.size() * curve25519_ge_byte_size);
-
-    return output;
 }
 
-std::vector<bytes_t> OT_HL17::recv(const std::vector<bool>& choices)
+void OT_HL17::recv_into(ot_key_t* output, const std::vector<bool>& choices)
 {
+    if (chunk_size_ > 0 && !choices.empty())
+    {
+        recv_pipelined(output, choices, 1, nullptr);
+        return;
+    }
+    if (shared_state_)
+    {
+        recv_shared(output, choices);
+        return;
+    }
+
     auto number_ots = choices.size();
     std::vector<Receiver_State> states(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<bytes_t> output(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> S_bytes(number_ots);
 
     auto fut_recv_msg_s0 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_s0.data()), msgs_s0.size() * curve25519_ge_byte_size);
 
@@ -275,59 +627,206 @@ std::vector<bytes_t> OT_HL17::recv(const std::vector<bool>& choices)
     auto msg_s0_size = fut_recv_msg_s0.get();
     assert(msg_s0_size == msgs_s0.size() * curve25519_ge_byte_size);
 
-    for (size_t i = 0; i < number_ots; ++i)
+    recv_1_batch(states.data(), msgs_r1.data(), S_bytes.data(), msgs_s0.data(), number_ots);
+
+    auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+
+    recv_2_batch(states.data(), output, S_bytes.data(), msgs_r1.data(), number_ots);
+
+    auto msg_r1_size = fut_send_msg_r1.get();
+    assert(msg_r1_size == msgs_s0.size() * curve25519_ge_byte_size);
+}
+
+
+namespace
+{
+
+/**
+ * Joins the asynchronous operations of a protocol run and reports the first
+ * error.
+ */
+class Completion
+{
+public:
+    Completion(size_t pending, RandomOT::done_handler_t done)
+        : pending_(pending), mutex_(), error_(), done_(std::move(done))
     {
-        recv_1(states[i], msgs_r1[i], msgs_s0[i]);
     }
 
-    auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+    /**
+     * Announce another operation.
+     */
+    void expect()
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+    }
 
-    for (size_t i = 0; i < number_ots; ++i)
+    void complete(std::error_code error)
     {
-        output[i] = recv_2(states[i]);
+        if (error)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+                error_ = error;
+        }
+        if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            done_(error_);
     }
 
-    auto msg_r1_size = fut_send_msg_r1.get();
-    assert(msg_r1_size == msgs_s0.size() * curve25519_ge_byte_size);
+private:
+    std::atomic<size_t> pending_;
+    std::mutex mutex_;
+    std::error_code error_;
+    RandomOT::done_handler_t done_;
+};
 
-    return output;
+}  // namespace
+
+void OT_HL17::async_send_into(ot_key_t* output, size_t number_ots, done_handler_t done)
+{
+    if (shared_state_ || chunk_size_ > 0)
+        throw std::logic_error("asynchronous HL17 supports only the default mode");
+
+    struct Operation
+    {
+        Operation(size_t number_ots, done_handler_t done)
+            : states(number_ots), msgs_s0(number_ots), msgs_r1(number_ots), completion(2, std::move(done))
+        {
+        }
+        std::vector<Sender_State> states;
+        std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0;
+        std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1;
+        Completion completion;
+    };
+    auto op = std::make_shared<Operation>(number_ots, std::move(done));
+    const auto size = number_ots * curve25519_ge_byte_size;
+
+    send_0_batch(op->states.data(), op->msgs_s0.data(), number_ots);
+    connection_.async_send(reinterpret_cast<uint8_t*>(op->msgs_s0.data()), size,
+        [op](std::error_code error, size_t)
+        {
+            op->completion.complete(error);
+        });
+    send_1_batch(op->states.data(), op->msgs_s0.data(), number_ots);
+    connection_.async_recv(reinterpret_cast<uint8_t*>(op->msgs_r1.data()), size,
+        [this, op, output, number_ots](std::error_code error, size_t)
+        {
+            if (error)
+            {
+                op->completion.complete(error);
+                return;
+            }
+            boost::asio::post(global_thread_pool(), [this, op, output, number_ots]
+                {
+                    send_2_batch(op->states.data(), output, op->msgs_s0.data(), op->msgs_r1.data(), number_ots);
+                    op->completion.complete(std::error_code());
+                });
+        });
 }
 
+void OT_HL17::async_recv_into(ot_key_t* output, const std::vector<bool>& choices, done_handler_t done)
+{
+    if (shared_state_ || chunk_size_ > 0)
+        throw std::logic_error("asynchronous HL17 supports only the default mode");
+
+    struct Operation
+    {
+        Operation(size_t number_ots, done_handler_t done)
+            : states(number_ots), msgs_s0(number_ots), msgs_r1(number_ots), S_bytes(number_ots),
+              completion(1, std::move(done))
+        {
+        }
+        std::vector<Receiver_State> states;
+        std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0;
+        std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1;
+        std::vector<std::array<uint8_t, curve25519_ge_byte_size>> S_bytes;
+        Completion completion;
+    };
+    const auto number_ots = choices.size();
+    auto op = std::make_shared<Operation>(number_ots, std::move(done));
+    const auto size = number_ots * curve25519_ge_byte_size;
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        recv_0(op->states[i], choices[i]);
+    }
+    connection_.async_recv(reinterpret_cast<uint8_t*>(op->msgs_s0.data()), size,
+        [this, op, output, number_ots, size](std::error_code error, size_t)
+        {
+            if (error)
+            {
+                op->completion.complete(error);
+                return;
+            }
+            boost::asio::post(global_thread_pool(), [this, op, output, number_ots, size]
+                {
+                    recv_1_batch(op->states.data(), op->msgs_r1.data(), op->S_bytes.data(), op->msgs_s0.data(), number_ots);
+                    op->completion.expect();
+                    connection_.async_send(reinterpret_cast<uint8_t*>(op->msgs_r1.data()), size,
+                        [op](std::error_code error, size_t)
+                        {
+                            op->completion.complete(error);
+                        });
+                    recv_2_batch(op->states.data(), output, op->S_bytes.data(), op->msgs_r1.data(), number_ots);
+                    op->completion.complete(std::error_code());
+                });
+        });
+}
 
-std::vector<std::pair<bytes_t, bytes_t>> OT_HL17::parallel_send(size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+
+void OT_HL17::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
 {
+    if (chunk_size_ > 0 && number_ots > 0)
+    {
+        send_pipelined(output, number_ots, number_threads, &thread_pool);
+        return;
+    }
+    if (shared_state_)
+    {
+        parallel_send_shared(output, number_ots, number_threads, thread_pool);
+        return;
+    }
+
     std::vector<Sender_State> states(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<std::pair<bytes_t, bytes_t>> output(number_ots);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &msgs_s0](size_t index){ send_0(states[index], msgs_s0[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &msgs_s0](size_t begin, size_t end){ send_0_batch(states.data() + begin, msgs_s0.data() + begin, end - begin); });
 
     auto fut_send_msg_s0 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_s0.data()), msgs_s0.size() * curve25519_ge_byte_size);
     auto fut_recv_msg_r1 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
 
 
-    compute(thread_pool, number_ots, number_threads, [this, &states](size_t index){ send_1(states[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &msgs_s0](size_t begin, size_t end){ send_1_batch(states.data() + begin, msgs_s0.data() + begin, end - begin); });
 
     auto msg_r1_size = fut_recv_msg_r1.get();
     assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &msgs_r1, &output](size_t index){ output[index] = send_2(states[index], msgs_r1[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &msgs_s0, &msgs_r1, output](size_t begin, size_t end){ send_2_batch(states.data() + begin, output + 2 * begin, msgs_s0.data() + begin, msgs_r1.data() + begin, end - begin); });
 
     auto msg_s0_size = fut_send_msg_s0.get();
     assert(msg_s0_size == msgs_s0.size() * curve25519_ge_byte_size);
-
-    return output;
 }
 
 
-std::vector<bytes_t> OT_HL17::parallel_recv(const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+void OT_HL17::parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
 {
+    if (chunk_size_ > 0 && !choices.empty())
+    {
+        recv_pipelined(output, choices, number_threads, &thread_pool);
+        return;
+    }
+    if (shared_state_)
+    {
+        parallel_recv_shared(output, choices, number_threads, thread_pool);
+        return;
+    }
+
     auto number_ots = choices.size();
     std::vector<Receiver_State> states(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(number_ots);
     std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
-    std::vector<bytes_t> output(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> S_bytes(number_ots);
 
     auto fut_recv_msg_s0 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_s0.data()), msgs_s0.size() * curve25519_ge_byte_size);
 
@@ -336,14 +835,368 @@ std::vector<bytes_t> OT_HL17::parallel_recv(const std::vector<bool>& choices, si
     auto msg_s0_size = fut_recv_msg_s0.get();
     assert(msg_s0_size == msgs_s0.size() * curve25519_ge_byte_size);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &msgs_r1, &msgs_s0](size_t index){ recv_1(states[index], msgs_r1[index], msgs_s0[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &msgs_r1, &S_bytes, &msgs_s0](size_t begin, size_t end){ recv_1_batch(states.data() + begin, msgs_r1.data() + begin, S_bytes.data() + begin, msgs_s0.data() + begin, end - begin); });
 
     auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
 
-    compute(thread_pool, number_ots, number_threads, [this, &states, &output](size_t index){ output[index] = recv_2(states[index]); });
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, output, &S_bytes, &msgs_r1](size_t begin, size_t end){ recv_2_batch(states.data() + begin, output + begin, S_bytes.data() + begin, msgs_r1.data() + begin, end - begin); });
 
     auto msg_r1_size = fut_send_msg_r1.get();
     assert(msg_r1_size == msgs_s0.size() * curve25519_ge_byte_size);
+}
 
-    return output;
+
+void OT_HL17::send_shared(ot_key_t* output, size_t number_ots)
+{
+    Sender_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+
+    send_0(sstate, msg_s0);
+
+    auto fut_send_msg_s0 = connection_.async_send(msg_s0.data(), msg_s0.size());
+    auto fut_recv_msg_r1 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+
+    send_1(sstate, msg_s0);
+
+    auto msg_r1_size = fut_recv_msg_r1.get();
+    assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
+
+    send_2_batch(sstate, output, msg_s0, msgs_r1.data(), number_ots);
+
+    auto msg_s0_size = fut_send_msg_s0.get();
+    assert(msg_s0_size == msg_s0.size());
+}
+
+void OT_HL17::recv_shared(ot_key_t* output, const std::vector<bool>& choices)
+{
+    auto number_ots = choices.size();
+    std::vector<Receiver_State> states(number_ots);
+    Receiver_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::array<uint8_t, curve25519_ge_byte_size> S_bytes;
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+
+    auto fut_recv_msg_s0 = connection_.async_recv(msg_s0.data(), msg_s0.size());
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        recv_0(states[i], choices[i]);
+    }
+
+    auto msg_s0_size = fut_recv_msg_s0.get();
+    assert(msg_s0_size == msg_s0.size());
+
+    recv_1(sstate, S_bytes, msg_s0);
+
+    recv_1_batch(states.data(), sstate, msgs_r1.data(), number_ots);
+
+    auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+
+    recv_2_batch(states.data(), sstate, output, S_bytes, msgs_r1.data(), number_ots);
+
+    auto msg_r1_size = fut_send_msg_r1.get();
+    assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
+}
+
+
+void OT_HL17::parallel_send_shared(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    Sender_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+
+    send_0(sstate, msg_s0);
+
+    auto fut_send_msg_s0 = connection_.async_send(msg_s0.data(), msg_s0.size());
+    auto fut_recv_msg_r1 = connection_.async_recv(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+
+    send_1(sstate, msg_s0);
+
+    auto msg_r1_size = fut_recv_msg_r1.get();
+    assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
+
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &sstate, &msg_s0, &msgs_r1, output](size_t begin, size_t end){ send_2_batch(sstate, output + 2 * begin, msg_s0, msgs_r1.data() + begin, end - begin); });
+
+    auto msg_s0_size = fut_send_msg_s0.get();
+    assert(msg_s0_size == msg_s0.size());
+}
+
+
+void OT_HL17::parallel_recv_shared(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    auto number_ots = choices.size();
+    std::vector<Receiver_State> states(number_ots);
+    Receiver_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::array<uint8_t, curve25519_ge_byte_size> S_bytes;
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+
+    auto fut_recv_msg_s0 = connection_.async_recv(msg_s0.data(), msg_s0.size());
+
+    compute(thread_pool, number_ots, number_threads, [this, &states, &choices](size_t index){ recv_0(states[index], choices[index]); });
+
+    auto msg_s0_size = fut_recv_msg_s0.get();
+    assert(msg_s0_size == msg_s0.size());
+
+    recv_1(sstate, S_bytes, msg_s0);
+
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &sstate, &msgs_r1](size_t begin, size_t end){ recv_1_batch(states.data() + begin, sstate, msgs_r1.data() + begin, end - begin); });
+
+    auto fut_send_msg_r1 = connection_.async_send(reinterpret_cast<uint8_t*>(msgs_r1.data()), msgs_r1.size() * curve25519_ge_byte_size);
+
+    compute_intervals(thread_pool, number_ots, number_threads, [this, &states, &sstate, output, &S_bytes, &msgs_r1](size_t begin, size_t end){ recv_2_batch(states.data() + begin, sstate, output + begin, S_bytes, msgs_r1.data() + begin, end - begin); });
+
+    auto msg_r1_size = fut_send_msg_r1.get();
+    assert(msg_r1_size == msgs_r1.size() * curve25519_ge_byte_size);
+}
+
+
+namespace {
+
+/**
+ * Sends buffers in the order in which they are pushed with the callback based
+ * async_send of the connection.  The operations are started from the global
+ * thread pool, so that the computation of the next chunk never waits for the
+ * network, even if the connection only implements blocking sends, and each
+ * party only ever blocks on receiving.
+ */
+class ChunkSender
+{
+public:
+    ChunkSender(Connection& connection)
+        : connection_(connection), mutex_(), cv_(), queue_(), sending_(false), error_()
+    {
+    }
+    ~ChunkSender()
+    {
+        // the pending operation references its buffer and this object
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!queue_.empty())
+            queue_.erase(queue_.begin() + 1, queue_.end());
+        cv_.wait(lock, [this] { return !sending_; });
+    }
+    ChunkSender(const ChunkSender&) = delete;
+    ChunkSender& operator=(const ChunkSender&) = delete;
+
+    /**
+     * Send the buffer, which has to stay valid until finish returns.
+     */
+    void push(const uint8_t* buffer, size_t length)
+    {
+        assert(length > 0);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (error_)
+            return;
+        queue_.emplace_back(buffer, length);
+        if (!sending_)
+        {
+            sending_ = true;
+            boost::asio::post(global_thread_pool(), [this] { send_front(); });
+        }
+    }
+
+    /**
+     * Wait until all buffers are sent and rethrow the first error.
+     */
+    void finish()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !sending_; });
+        if (error_)
+            std::rethrow_exception(error_);
+    }
+
+private:
+    void send_front()
+    {
+        std::pair<const uint8_t*, size_t> front;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            front = queue_.front();
+        }
+        try
+        {
+            connection_.async_send(front.first, front.second, [this](std::error_code error, size_t)
+                {
+                    if (error)
+                        fail(std::make_exception_ptr(std::system_error(error)));
+                    else
+                        sent();
+                });
+        }
+        catch (...)
+        {
+            fail(std::current_exception());
+        }
+    }
+
+    /**
+     * Start the next operation in the pool instead of the completion
+     * handler, which may run in an I/O thread.
+     */
+    void sent()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.pop_front();
+        if (queue_.empty())
+        {
+            sending_ = false;
+            cv_.notify_all();
+            return;
+        }
+        boost::asio::post(global_thread_pool(), [this] { send_front(); });
+    }
+
+    void fail(std::exception_ptr error)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_)
+            error_ = error;
+        queue_.clear();
+        sending_ = false;
+        cv_.notify_all();
+    }
+
+    Connection& connection_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::pair<const uint8_t*, size_t>> queue_;
+    // whether an operation is pending
+    bool sending_;
+    std::exception_ptr error_;
+};
+
+}  // namespace
+
+
+void OT_HL17::send_pipelined(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    const auto number_chunks = (number_ots + chunk_size_ - 1) / chunk_size_;
+    auto chunk = [this, number_ots](size_t k) { return std::make_pair(k * chunk_size_, std::min(number_ots, (k + 1) * chunk_size_)); };
+
+    Sender_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::vector<Sender_State> states(shared_state_ ? 0 : number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(shared_state_ ? 0 : number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+
+    auto recv_chunk = [this, &chunk, &msgs_r1](size_t k)
+    {
+        auto [begin, end] = chunk(k);
+        return connection_.async_recv(msgs_r1[begin].data(), (end - begin) * curve25519_ge_byte_size);
+    };
+    auto process_chunk = [this, &chunk, &sstate, &msg_s0, &states, &msgs_s0, &msgs_r1, output, thread_pool, number_threads](size_t k, std::future<size_t> fut_recv_msg_r1)
+    {
+        auto [begin, end] = chunk(k);
+        auto msg_r1_size = fut_recv_msg_r1.get();
+        assert(msg_r1_size == (end - begin) * curve25519_ge_byte_size);
+        if (shared_state_)
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &sstate, &msg_s0, &msgs_r1, output](size_t b, size_t e){ send_2_batch(sstate, output + 2 * b, msg_s0, msgs_r1.data() + b, e - b); });
+        else
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &msgs_s0, &msgs_r1, output](size_t b, size_t e){ send_2_batch(states.data() + b, output + 2 * b, msgs_s0.data() + b, msgs_r1.data() + b, e - b); });
+    };
+
+    ChunkSender chunk_sender(connection_);
+    if (shared_state_)
+    {
+        send_0(sstate, msg_s0);
+        chunk_sender.push(msg_s0.data(), msg_s0.size());
+        send_1(sstate, msg_s0);
+
+        // chunk k of the R is processed while chunk k+1 is received
+        auto fut_recv_msg_r1 = recv_chunk(0);
+        for (size_t k = 0; k < number_chunks; ++k)
+        {
+            auto fut_current = std::move(fut_recv_msg_r1);
+            fut_current.wait();
+            if (k + 1 < number_chunks)
+                fut_recv_msg_r1 = recv_chunk(k + 1);
+            process_chunk(k, std::move(fut_current));
+        }
+    }
+    else
+    {
+        // chunk k of the S is computed while the other party processes chunk
+        // k-1, then chunk k-1 of the R is received and processed while chunk
+        // k is on the wire
+        for (size_t k = 0; k < number_chunks; ++k)
+        {
+            auto [begin, end] = chunk(k);
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &msgs_s0](size_t b, size_t e){ send_0_batch(states.data() + b, msgs_s0.data() + b, e - b); });
+            chunk_sender.push(msgs_s0[begin].data(), (end - begin) * curve25519_ge_byte_size);
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &msgs_s0](size_t b, size_t e){ send_1_batch(states.data() + b, msgs_s0.data() + b, e - b); });
+            if (k > 0)
+                process_chunk(k - 1, recv_chunk(k - 1));
+        }
+        process_chunk(number_chunks - 1, recv_chunk(number_chunks - 1));
+    }
+
+    chunk_sender.finish();
+}
+
+
+void OT_HL17::recv_pipelined(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    const auto number_ots = choices.size();
+    const auto number_chunks = (number_ots + chunk_size_ - 1) / chunk_size_;
+    auto chunk = [this, number_ots](size_t k) { return std::make_pair(k * chunk_size_, std::min(number_ots, (k + 1) * chunk_size_)); };
+
+    Receiver_SharedState sstate;
+    std::array<uint8_t, curve25519_ge_byte_size> msg_s0;
+    std::array<uint8_t, curve25519_ge_byte_size> S_bytes;
+    std::vector<Receiver_State> states(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_s0(shared_state_ ? 0 : number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> msgs_r1(number_ots);
+    std::vector<std::array<uint8_t, curve25519_ge_byte_size>> Ss_bytes(shared_state_ ? 0 : number_ots);
+
+    auto fut_recv_msg_s0 = shared_state_
+        ? connection_.async_recv(msg_s0.data(), msg_s0.size())
+        : connection_.async_recv(msgs_s0[0].data(), chunk(0).second * curve25519_ge_byte_size);
+
+    for_each_interval(thread_pool, number_threads, 0, number_ots, [this, &states, &choices](size_t b, size_t e)
+        {
+            for (size_t i = b; i < e; ++i)
+            {
+                recv_0(states[i], choices[i]);
+            }
+        });
+
+    if (shared_state_)
+    {
+        auto msg_s0_size = fut_recv_msg_s0.get();
+        assert(msg_s0_size == msg_s0.size());
+        recv_1(sstate, S_bytes, msg_s0);
+    }
+
+    // chunk k is processed while chunk k+1 of the S is computed by the other
+    // party and chunk k of the R is sent.  The next chunk is only received
+    // afterwards, since the other party may not send it before it received
+    // chunk k-1 of the R.
+    ChunkSender chunk_sender(connection_);
+    for (size_t k = 0; k < number_chunks; ++k)
+    {
+        auto [begin, end] = chunk(k);
+        if (shared_state_)
+        {
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &sstate, &msgs_r1](size_t b, size_t e){ recv_1_batch(states.data() + b, sstate, msgs_r1.data() + b, e - b); });
+            chunk_sender.push(msgs_r1[begin].data(), (end - begin) * curve25519_ge_byte_size);
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &sstate, &S_bytes, &msgs_r1, output](size_t b, size_t e){ recv_2_batch(states.data() + b, sstate, output + b, S_bytes, msgs_r1.data() + b, e - b); });
+        }
+        else
+        {
+            auto msg_s0_size = fut_recv_msg_s0.get();
+            assert(msg_s0_size == (end - begin) * curve25519_ge_byte_size);
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &msgs_r1, &Ss_bytes, &msgs_s0](size_t b, size_t e){ recv_1_batch(states.data() + b, msgs_r1.data() + b, Ss_bytes.data() + b, msgs_s0.data() + b, e - b); });
+            chunk_sender.push(msgs_r1[begin].data(), (end - begin) * curve25519_ge_byte_size);
+            for_each_interval(thread_pool, number_threads, begin, end, [this, &states, &Ss_bytes, &msgs_r1, output](size_t b, size_t e){ recv_2_batch(states.data() + b, output + b, Ss_bytes.data() + b, msgs_r1.data() + b, e - b); });
+            if (k + 1 < number_chunks)
+            {
+                auto [next_begin, next_end] = chunk(k + 1);
+                fut_recv_msg_s0 = connection_.async_recv(msgs_s0[next_begin].data(), (next_end - next_begin) * curve25519_ge_byte_size);
+            }
+        }
+    }
+
+    chunk_sender.finish();
 }
@@ -23,6 +23,7 @@
 #ifndef OT_HL17_HPP
 #define OT_HL17_HPP
 
+#include <array>
 #include "ot.hpp"
 #include "network/connection.hpp"
 #include "curve25519/mycurve25519.h"
@@ -35,7 +36,21 @@
 class OT_HL17 : public RandomOT
 {
 public:
-    OT_HL17(Connection& connection);
+    /**
+     * If shared_state is set, the batch methods use a single sender message
+     * S (and hence a single T = G(S)) for all OTs of a batch.  Then y*T is
+     * computed once and y*(R - T) = y*R - y*T, which saves one variable-base
+     * scalar multiplication per OT.  Both parties need to use the same mode.
+     */
+    OT_HL17(Connection& connection, bool shared_state = false);
+
+    /**
+     * Split batches into chunks of chunk_size OTs which are sent as soon as
+     * they are computed.  Then chunk k is on the wire while chunk k+1 is
+     * computed and the other party processes chunk k-1.  0 (the default)
+     * disables the pipeline.  Both parties need to use the same chunk size.
+     */
+    void set_chunk_size(size_t chunk_size);
 
     /**
      * Send/receive for a single random OT.
@@ -46,23 +61,53 @@ public:
     /**
      * Send/receive parts of the random OT protocol (batch version).
      */
-    std::vector<std::pair<bytes_t, bytes_t>> send(size_t) override;
-    std::vector<bytes_t> recv(const std::vector<bool>&) override;
-    /**
-     * Parallelized version of batch send/receive.
-     * These methods will create a new thread pool.
-     */
+    using RandomOT::send;
+    using RandomOT::recv;
     using RandomOT::parallel_send;
     using RandomOT::parallel_recv;
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     */
+    void send_into(ot_key_t* output, size_t number_ots) override;
+    void recv_into(ot_key_t* output, const std::vector<bool>& choices) override;
     /**
      * Parallelized version of batch send/receive.
      * These methods will use the given thread pool.
      */
-    std::vector<std::pair<bytes_t, bytes_t>> parallel_send(size_t, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
-    std::vector<bytes_t> parallel_recv(const std::vector<bool>&, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    using RandomOT::parallel_send_into;
+    using RandomOT::parallel_recv_into;
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    /**
+     * Asynchronous batch send/receive.  The protocol is a state machine
+     * driven by the completion handlers of the connection.  These handlers
+     * only post the computation to the global thread pool, which then
+     * starts the next operation, so that the I/O thread is never blocked.
+     * Hence, done is called from a thread of the global pool, and with a
+     * TCPConnection its io_context has to be kept running until then.
+     * Only available without shared state and pipelining.
+     */
+    void async_send_into(ot_key_t* output, size_t number_ots, done_handler_t done) override;
+    void async_recv_into(ot_key_t* output, const std::vector<bool>& choices, done_handler_t done) override;
 private:
 
+    /**
+     * Batch send/receive with a single S/T.
+     */
+    void send_shared(ot_key_t* output, size_t number_ots);
+    void recv_shared(ot_key_t* output, const std::vector<bool>& choices);
+    void parallel_send_shared(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool);
+    void parallel_recv_shared(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool);
+    /**
+     * Chunked batch send/receive (for both modes).  If thread_pool is
+     * nullptr everything is computed in the calling thread.
+     */
+    void send_pipelined(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    void recv_pipelined(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool);
+
     Connection& connection_;
+    bool shared_state_;
+    size_t chunk_size_;
 
 public: // for testing
     struct Sender_State
@@ -90,12 +135,32 @@ public: // for testing
         // k_R
         // e_c
     };
+    struct Sender_SharedState
+    {
+        // y
+        uint8_t y[32];
+        // S
+        curve25519::ge_p3 S;
+        // T
+        curve25519::ge_p3 T;
+        // y*T
+        curve25519::ge_cached y_times_T;
+    };
+    struct Receiver_SharedState
+    {
+        // S
+        curve25519::ge_p3 S;
+        // T
+        curve25519::ge_cached T;
+    };
     static const size_t curve25519_ge_byte_size = 32;
 
     /**
      * Hash G -> G
      */
     void hash_point(curve25519::ge_p3& output, const curve25519::ge_p3& input);
+    void hash_point(curve25519::ge_p3& output,
+                    const std::array<uint8_t, curve25519_ge_byte_size>& input);
 
     /**
      * Parts of the sender side.
@@ -105,6 +170,11 @@ public: // for testing
     void send_1(Sender_State& state);
     std::pair<bytes_t, bytes_t> send_2(Sender_State& state,
                                        const std::array<uint8_t, curve25519_ge_byte_size>& message_in);
+    /**
+     * Variant of send_2 for an already decoded (and validated) point R.
+     */
+    std::pair<bytes_t, bytes_t> send_2(Sender_State& state,
+                                       const curve25519::ge_p3& R);
 
     /**
      * Parts of the receiver side.
@@ -114,6 +184,60 @@ public: // for testing
                 std::array<uint8_t, curve25519_ge_byte_size>& message_out,
                 const std::array<uint8_t, curve25519_ge_byte_size>& message_in);
     bytes_t recv_2(Receiver_State& state);
+
+    /**
+     * Batch versions of the parts above for number_ots OTs.  The point
+     * encodings of a batch share their field inversions.  S_bytes receives
+     * the canonical encodings of the received points S.  The keys are
+     * written to output as in RandomOT::send_into/recv_into.
+     */
+    void send_0_batch(Sender_State* states,
+                      std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                      size_t number_ots);
+    void send_1_batch(Sender_State* states,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_s0,
+                      size_t number_ots);
+    void send_2_batch(Sender_State* states,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_s0,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                      size_t number_ots);
+    void recv_1_batch(Receiver_State* states,
+                      std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                      std::array<uint8_t, curve25519_ge_byte_size>* S_bytes,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                      size_t number_ots);
+    void recv_2_batch(Receiver_State* states,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* S_bytes,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                      size_t number_ots);
+
+    /**
+     * Parts of the protocol with a single S/T for a batch of OTs.  Only the
+     * fields choice, x and R of the Receiver_States are used.  recv_1 writes
+     * the canonical encoding of S to S_bytes.
+     */
+    void send_0(Sender_SharedState& sstate,
+                std::array<uint8_t, curve25519_ge_byte_size>& message_out);
+    void send_1(Sender_SharedState& sstate,
+                const std::array<uint8_t, curve25519_ge_byte_size>& message_s0);
+    void send_2_batch(const Sender_SharedState& sstate,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>& message_s0,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_in,
+                      size_t number_ots);
+    void recv_1(Receiver_SharedState& sstate,
+                std::array<uint8_t, curve25519_ge_byte_size>& S_bytes,
+                const std::array<uint8_t, curve25519_ge_byte_size>& message_in);
+    void recv_1_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                      std::array<uint8_t, curve25519_ge_byte_size>* messages_out,
+                      size_t number_ots);
+    void recv_2_batch(Receiver_State* states, const Receiver_SharedState& sstate,
+                      ot_key_t* output,
+                      const std::array<uint8_t, curve25519_ge_byte_size>& S_bytes,
+                      const std::array<uint8_t, curve25519_ge_byte_size>* messages_r1,
+                      size_t number_ots);
 };
 
 
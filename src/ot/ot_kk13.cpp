@@ -0,0 +1,193 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <boost/asio.hpp>
+#include <botan/blake2b.h>
+#include "ot_kk13.hpp"
+#include "util/bit_matrix.hpp"
+#include "util/threading.hpp"
+
+using iknp::hash_row;
+using iknp::pad_number_ots;
+
+
+OT_KK13::OT_KK13(Connection& connection, RandomOT& base_ot, size_t number_messages)
+    : connection_(connection), number_messages_(number_messages),
+      sender_(base_ot, code_length), masked_codewords_(), sender_counter_(0),
+      receiver_(base_ot, code_length), receiver_counter_(0)
+{
+    if (number_messages < 2 || number_messages > max_number_messages)
+        throw std::invalid_argument("OT_KK13: number of messages must be in [2, 256]");
+}
+
+OT_KK13::~OT_KK13() = default;
+
+// Notation: see iknp.hpp with k = code_length and
+// * C: {0,1}^8 -> {0,1}^k Walsh-Hadamard code, C(c)_i = parity(c and i)
+// * random oracle H: N x {0,1}^k -> {0,1}^128
+//
+// The receiver's column r^i consists of the bits i of the codewords C(c_j).
+
+
+// C(c)
+static std::array<uint8_t, OT_KK13::code_length / 8> codeword(size_t c)
+{
+    std::array<uint8_t, OT_KK13::code_length / 8> word{};
+    for (size_t i = 0; i < OT_KK13::code_length; ++i)
+    {
+        word[i / 8] |= static_cast<uint8_t>(__builtin_parityl(c & i) << (i % 8));
+    }
+    return word;
+}
+
+
+void OT_KK13::send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    if (!sender_.ready())
+    {
+        sender_.setup(number_threads, thread_pool);
+
+        // C(r) and s
+        masked_codewords_.resize(number_messages_);
+        for (size_t r = 0; r < number_messages_; ++r)
+        {
+            const auto word = codeword(r);
+            std::transform(word.cbegin(), word.cend(), sender_.s(), masked_codewords_[r].begin(),
+                           [](auto a, auto b) { return a & b; });
+        }
+    }
+
+    const auto number_rows = pad_number_ots(number_ots);
+    const auto column_size = number_rows / 8;
+
+    // recv U
+    bytes_t matrix(code_length * column_size);
+    connection_.recv(matrix.data(), matrix.size());
+
+    // q^i = G(k_i^{s_i}) xor s_i * u^i
+    //     = t^i xor s_i * r^i
+    sender_.compute_q(matrix.data(), column_size, number_threads, thread_pool);
+
+    // q_j = t_j xor (C(c_j) and s)
+    std::vector<row_t> rows(number_rows);
+    transpose_bit_matrix(reinterpret_cast<uint8_t*>(rows.data()), matrix.data(),
+                         code_length, number_rows);
+
+    // H(j, q_j xor (C(r) and s)) for r < N
+    for_each_interval(thread_pool, number_threads, number_ots,
+        [this, &rows, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            row_t masked_row;
+            for (size_t j = begin; j < end; ++j)
+            {
+                for (size_t r = 0; r < number_messages_; ++r)
+                {
+                    std::transform(rows[j].cbegin(), rows[j].cend(), masked_codewords_[r].cbegin(),
+                                   masked_row.begin(), [](auto a, auto b) { return a ^ b; });
+                    hash_row(hash, output[number_messages_ * j + r].data(), sender_counter_ + j,
+                             masked_row.data(), masked_row.size());
+                }
+            }
+        });
+
+    sender_counter_ += number_ots;
+}
+
+void OT_KK13::recv_impl(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    if (std::any_of(choices.cbegin(), choices.cend(), [this](auto c) { return c >= number_messages_; }))
+        throw std::invalid_argument("OT_KK13: choice out of range");
+
+    if (!receiver_.ready())
+        receiver_.setup(number_threads, thread_pool);
+
+    const auto number_ots = choices.size();
+    const auto number_rows = pad_number_ots(number_ots);
+    const auto column_size = number_rows / 8;
+
+    std::vector<row_t> codewords(number_messages_);
+    for (size_t c = 0; c < number_messages_; ++c)
+    {
+        codewords[c] = codeword(c);
+    }
+
+    // r^i = column i of the matrix with rows C(c_j)
+    std::vector<row_t> rows(number_rows);
+    for (size_t j = 0; j < number_ots; ++j)
+    {
+        rows[j] = codewords[choices[j]];
+    }
+    bytes_t matrix_t(code_length * column_size);
+    bytes_t matrix_u(code_length * column_size);
+    transpose_bit_matrix(matrix_u.data(), reinterpret_cast<const uint8_t*>(rows.data()),
+                         number_rows, code_length);
+
+    // t^i = G(k_i^0)
+    // u^i = t^i xor G(k_i^1) xor r^i
+    receiver_.compute_t_u(matrix_t.data(), matrix_u.data(), column_size, number_threads, thread_pool);
+
+    auto fut_send_u = connection_.async_send(matrix_u.data(), matrix_u.size());
+
+    transpose_bit_matrix(reinterpret_cast<uint8_t*>(rows.data()), matrix_t.data(),
+                         code_length, number_rows);
+
+    // H(j, t_j)
+    for_each_interval(thread_pool, number_threads, number_ots,
+        [this, &rows, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            for (size_t j = begin; j < end; ++j)
+            {
+                hash_row(hash, output[j].data(), receiver_counter_ + j, rows[j].data(), rows[j].size());
+            }
+        });
+
+    auto u_size = fut_send_u.get();
+    assert(u_size == matrix_u.size());
+
+    receiver_counter_ += number_ots;
+}
+
+
+void OT_KK13::send_into(ot_key_t* output, size_t number_ots)
+{
+    send_impl(output, number_ots, 1, nullptr);
+}
+
+void OT_KK13::recv_into(ot_key_t* output, const std::vector<size_t>& choices)
+{
+    recv_impl(output, choices, 1, nullptr);
+}
+
+void OT_KK13::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    send_impl(output, number_ots, number_threads, &thread_pool);
+}
+
+void OT_KK13::parallel_recv_into(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    recv_impl(output, choices, number_threads, &thread_pool);
+}
@@ -0,0 +1,87 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OT_KK13_HPP
+#define OT_KK13_HPP
+
+#include <array>
+#include <memory>
+#include "ot.hpp"
+#include "iknp.hpp"
+#include "network/connection.hpp"
+
+
+/**
+ * A 1-out-of-N random OT extension for N <= 256 based on the protocol by
+ * Kolesnikov and Kumaresan (2013) https://eprint.iacr.org/2013/491.
+ *
+ * It works as the IKNP03 extension (see OTExtension), but the receiver
+ * encodes its choice c with the Walsh-Hadamard code C: {0,1}^8 -> {0,1}^256,
+ * C(c)_i = <c, i> mod 2, instead of repeating a single bit.  Thus, the 256
+ * base OTs are obtained from another random OT implementation (e.g. OT_HL17
+ * or OT_CO15) on the same connection, and every OT costs 32 bytes of
+ * communication independently of N.  The sender's keys are
+ * H(j, q_j xor (C(r) and s)) for r < N.
+ */
+class OT_KK13 : public RandomOT_N
+{
+public:
+    OT_KK13(Connection& connection, RandomOT& base_ot, size_t number_messages);
+    ~OT_KK13();
+
+    size_t number_messages() const override { return number_messages_; }
+
+    using RandomOT_N::parallel_send_into;
+    using RandomOT_N::parallel_recv_into;
+    void send_into(ot_key_t* output, size_t number_ots) override;
+    void recv_into(ot_key_t* output, const std::vector<size_t>& choices) override;
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    void parallel_recv_into(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+
+    static constexpr size_t code_length = 256;
+    static constexpr size_t max_number_messages = 256;
+    static constexpr size_t key_size = 16;
+
+private:
+    using row_t = std::array<uint8_t, code_length / 8>;
+
+    /**
+     * Implementation of the batch send/receive.  If thread_pool is nullptr
+     * everything is computed in the calling thread.
+     */
+    void send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    void recv_impl(ot_key_t* output, const std::vector<size_t>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+    Connection& connection_;
+    const size_t number_messages_;
+
+    // sender side: additionally C(r) and s for all r
+    iknp::Sender sender_;
+    std::vector<row_t> masked_codewords_;
+    uint64_t sender_counter_;
+
+    iknp::Receiver receiver_;
+    uint64_t receiver_counter_;
+};
+
+
+#endif // OT_KK13_HPP
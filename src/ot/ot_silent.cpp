@@ -0,0 +1,470 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <botan/blake2b.h>
+#include <botan/block_cipher.h>
+#include <botan/stream_cipher.h>
+#include "ot_silent.hpp"
+#include "util/threading.hpp"
+
+
+SilentOT::SilentOT(Connection& connection, RandomOT& base_ot)
+    : connection_(connection), base_ot_(base_ot), sender_counter_(0), receiver_counter_(0)
+{
+}
+
+// Notation
+// * n OTs, t trees with 2^d leaves, N = t * 2^d >= 2 * n
+// * PRG G: {0,1}^k -> {0,1}^2k of the trees, G(s) = (AES_k0(s) xor s,
+//   AES_k1(s) xor s) with fixed keys k0, k1
+// * code C: {0,1}^{k x N} -> {0,1}^{k x n}, C(x)_i is the sum of 7 entries
+//   of the prefix sums of x at pseudorandom positions, which are derived from
+//   the index of the first OT of the batch
+// * random oracle H: N x {0,1}^k -> {0,1}^k
+//
+// Level l of a tree consists of the nodes 0, ..., 2^l - 1, the children of
+// node i are 2i and 2i+1.  K_l^b is the sum of the nodes at level l whose
+// index has parity b.  For tree j and level l, the receiver learns
+// K_l^{1-a_l} with the base OT j * d + l - 1, where a_l is the l-th bit (from
+// the top) of its punctured point alpha_j.  Together with the nodes it knows
+// already, this gives all nodes of the level except the one on the path to
+// alpha_j.  Finally, the sender sends c_j = D xor (sum of all leaves), from
+// which the receiver computes the leaf at alpha_j xor D.
+
+
+static void xor_block(ot_key_t& a, const ot_key_t& b)
+{
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] ^= b[i];
+    }
+}
+
+static ot_key_t random_block()
+{
+    ot_key_t block{};
+    auto bytes = random_bytes(block.size());
+    std::copy(bytes.cbegin(), bytes.cend(), block.begin());
+    return block;
+}
+
+// H(index, block)
+static void hash_block(Botan::Blake2b& hash, uint8_t* output, uint64_t index, const ot_key_t& block)
+{
+    std::array<uint8_t, 8> index_bytes;
+    for (size_t i = 0; i < index_bytes.size(); ++i)
+    {
+        index_bytes[i] = static_cast<uint8_t>(index >> (8 * i));
+    }
+    hash.update(index_bytes.data(), index_bytes.size());
+    hash.update(block.data(), block.size());
+    hash.final(output);
+}
+
+
+// The PRG G of the GGM trees.
+class TreePRG
+{
+public:
+    TreePRG()
+        : ciphers_{{Botan::BlockCipher::create_or_throw("AES-128"), Botan::BlockCipher::create_or_throw("AES-128")}},
+          buffer_()
+    {
+        for (size_t b = 0; b < 2; ++b)
+        {
+            ot_key_t key{};
+            key[0] = static_cast<uint8_t>(b);
+            ciphers_[b]->set_key(key.data(), key.size());
+        }
+    }
+
+    // Replace the nodes 0, ..., n-1 of a level by their 2n children.
+    void expand(ot_key_t* nodes, size_t n)
+    {
+        buffer_.resize(2 * n);
+        ciphers_[0]->encrypt_n(nodes->data(), buffer_[0].data(), n);
+        ciphers_[1]->encrypt_n(nodes->data(), buffer_[n].data(), n);
+        // backwards, so that node i is read before it is overwritten
+        for (size_t i = n; i-- > 0;)
+        {
+            const auto parent = nodes[i];
+            nodes[2 * i] = buffer_[i];
+            xor_block(nodes[2 * i], parent);
+            nodes[2 * i + 1] = buffer_[n + i];
+            xor_block(nodes[2 * i + 1], parent);
+        }
+    }
+
+private:
+    std::array<std::unique_ptr<Botan::BlockCipher>, 2> ciphers_;
+    std::vector<ot_key_t> buffer_;
+};
+
+
+// Positions of the code for the outputs [begin, end), 8 per output of which
+// the first expander_weight are used.
+static void code_positions(std::vector<uint32_t>& positions, uint64_t batch_index, size_t code_size,
+                           size_t begin, size_t end)
+{
+    static_assert(SilentOT::expander_weight <= 8);
+    auto prg = Botan::StreamCipher::create_or_throw("CTR-BE(AES-128)");
+    ot_key_t key{};
+    for (size_t i = 0; i < 8; ++i)
+    {
+        key[i] = static_cast<uint8_t>(batch_index >> (8 * i));
+    }
+    prg->set_key(key.data(), key.size());
+    // 32 bytes per output, the counter starts at block 2 * begin
+    ot_key_t iv{};
+    for (size_t i = 0; i < 8; ++i)
+    {
+        iv[iv.size() - 1 - i] = static_cast<uint8_t>(static_cast<uint64_t>(2 * begin) >> (8 * i));
+    }
+    prg->set_iv(iv.data(), iv.size());
+
+    bytes_t stream(32 * (end - begin));
+    prg->cipher1(stream.data(), stream.size());
+    positions.resize(8 * (end - begin));
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        uint32_t x = 0;
+        for (size_t k = 0; k < 4; ++k)
+        {
+            x |= static_cast<uint32_t>(stream[4 * i + k]) << (8 * k);
+        }
+        positions[i] = static_cast<uint32_t>((static_cast<uint64_t>(x) * code_size) >> 32);
+    }
+}
+
+// Replace x by its prefix sums and compute output[i] = C(x)_i for i in
+// [0, n).
+template <typename T>
+static void encode(T* output, T* x, size_t n, size_t code_size, uint64_t batch_index,
+                   size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    for (size_t i = 1; i < code_size; ++i)
+    {
+        for (size_t k = 0; k < x[i].size(); ++k)
+        {
+            x[i][k] ^= x[i - 1][k];
+        }
+    }
+
+    for_each_interval(thread_pool, number_threads, n,
+        [output, x, code_size, batch_index](size_t begin, size_t end)
+        {
+            const size_t chunk_size = 4096;
+            std::vector<uint32_t> positions;
+            for (size_t c = begin; c < end; c += chunk_size)
+            {
+                const auto c_end = std::min(c + chunk_size, end);
+                code_positions(positions, batch_index, code_size, c, c_end);
+                for (size_t i = c; i < c_end; ++i)
+                {
+                    T y = x[positions[8 * (i - c)]];
+                    for (size_t w = 1; w < SilentOT::expander_weight; ++w)
+                    {
+                        const auto& entry = x[positions[8 * (i - c) + w]];
+                        for (size_t k = 0; k < y.size(); ++k)
+                        {
+                            y[k] ^= entry[k];
+                        }
+                    }
+                    output[i] = y;
+                }
+            }
+        });
+}
+
+
+SilentOT::Parameters SilentOT::get_parameters(size_t number_ots)
+{
+    // the largest trees such that there are at least noise_weight of them
+    size_t depth = 1;
+    while ((noise_weight << (depth + 1)) <= 2 * number_ots)
+    {
+        ++depth;
+    }
+    const size_t tree_size = size_t(1) << depth;
+    const auto number_trees = std::max(noise_weight, (2 * number_ots + tree_size - 1) / tree_size);
+    return {number_ots, number_trees, depth, number_trees * tree_size};
+}
+
+
+void SilentOT::send_batch(ot_key_t* output, const Parameters& parameters, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    const auto number_trees = parameters.number_trees;
+    const auto depth = parameters.depth;
+    const size_t tree_size = size_t(1) << depth;
+
+    // random OTs for the levels of all trees
+    std::vector<ot_key_t> base_keys(2 * number_trees * depth);
+    if (thread_pool == nullptr)
+        base_ot_.send_into(base_keys.data(), number_trees * depth);
+    else
+        base_ot_.parallel_send_into(base_keys.data(), number_trees * depth, number_threads, *thread_pool);
+
+    const auto delta = random_block();
+
+    // v = leaves of the trees
+    // message for tree j: (K_l^0 xor m_{j,l}^0, K_l^1 xor m_{j,l}^1) for all l, c_j
+    std::vector<block_t> v(parameters.code_size);
+    std::vector<block_t> message(number_trees * (2 * depth + 1));
+    for_each_index(thread_pool, number_threads, number_trees,
+        [&v, &message, &base_keys, &delta, depth, tree_size](size_t j)
+        {
+            TreePRG prg;
+            auto nodes = v.data() + j * tree_size;
+            auto tree_message = message.data() + j * (2 * depth + 1);
+            nodes[0] = random_block();
+            for (size_t l = 1; l <= depth; ++l)
+            {
+                prg.expand(nodes, size_t(1) << (l - 1));
+                block_t sums[2] = {{}, {}};
+                for (size_t i = 0; i < (size_t(1) << l); ++i)
+                {
+                    xor_block(sums[i & 1], nodes[i]);
+                }
+                for (size_t b = 0; b < 2; ++b)
+                {
+                    tree_message[2 * (l - 1) + b] = sums[b];
+                    xor_block(tree_message[2 * (l - 1) + b], base_keys[2 * (j * depth + l - 1) + b]);
+                }
+            }
+            block_t c = delta;
+            for (size_t i = 0; i < tree_size; ++i)
+            {
+                xor_block(c, nodes[i]);
+            }
+            tree_message[2 * depth] = c;
+        });
+    connection_.send(message.data()->data(), message.size() * sizeof(block_t));
+
+    // s = C(v)
+    std::vector<block_t> s(parameters.number_ots);
+    encode(s.data(), v.data(), s.size(), v.size(), sender_counter_, number_threads, thread_pool);
+
+    // (H(i, s_i), H(i, s_i xor D))
+    for_each_interval(thread_pool, number_threads, parameters.number_ots,
+        [this, &s, &delta, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            for (size_t i = begin; i < end; ++i)
+            {
+                hash_block(hash, output[2 * i].data(), sender_counter_ + i, s[i]);
+                xor_block(s[i], delta);
+                hash_block(hash, output[2 * i + 1].data(), sender_counter_ + i, s[i]);
+            }
+        });
+
+    sender_counter_ += parameters.number_ots;
+}
+
+std::vector<bool> SilentOT::recv_batch(ot_key_t* output, const Parameters& parameters, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    const auto number_trees = parameters.number_trees;
+    const auto depth = parameters.depth;
+    const size_t tree_size = size_t(1) << depth;
+
+    // sample the punctured points alpha_j
+    std::vector<size_t> alphas(number_trees);
+    auto alpha_bytes = random_bytes(8 * number_trees);
+    for (size_t j = 0; j < number_trees; ++j)
+    {
+        uint64_t alpha = 0;
+        for (size_t k = 0; k < 8; ++k)
+        {
+            alpha |= static_cast<uint64_t>(alpha_bytes[8 * j + k]) << (8 * k);
+        }
+        alphas[j] = alpha & (tree_size - 1);
+    }
+
+    // receive m_{j,l}^{1-a_l}
+    std::vector<bool> base_choices(number_trees * depth);
+    for (size_t j = 0; j < number_trees; ++j)
+    {
+        for (size_t l = 1; l <= depth; ++l)
+        {
+            base_choices[j * depth + l - 1] = !((alphas[j] >> (depth - l)) & 1);
+        }
+    }
+    std::vector<ot_key_t> base_keys(number_trees * depth);
+    if (thread_pool == nullptr)
+        base_ot_.recv_into(base_keys.data(), base_choices);
+    else
+        base_ot_.parallel_recv_into(base_keys.data(), base_choices, number_threads, *thread_pool);
+
+    std::vector<block_t> message(number_trees * (2 * depth + 1));
+    connection_.recv(message.data()->data(), message.size() * sizeof(block_t));
+
+    // w = leaves of the punctured trees with w_alpha = v_alpha xor D
+    // e = unit vectors at alpha
+    std::vector<block_t> w(parameters.code_size);
+    std::vector<std::array<uint8_t, 1>> e(parameters.code_size);
+    for_each_index(thread_pool, number_threads, number_trees,
+        [&w, &e, &message, &base_keys, &alphas, depth, tree_size](size_t j)
+        {
+            TreePRG prg;
+            auto nodes = w.data() + j * tree_size;
+            const auto tree_message = message.data() + j * (2 * depth + 1);
+            // node on the path at the current level, which is unknown and zero
+            size_t path = 0;
+            for (size_t l = 1; l <= depth; ++l)
+            {
+                prg.expand(nodes, size_t(1) << (l - 1));
+                const size_t a = (alphas[j] >> (depth - l)) & 1;
+                const size_t sibling = 2 * path + (1 - a);
+                path = 2 * path + a;
+                nodes[path] = block_t{};
+                // K_l^{1-a} minus the other nodes with the parity of the sibling
+                block_t sum = tree_message[2 * (l - 1) + (1 - a)];
+                xor_block(sum, base_keys[j * depth + l - 1]);
+                nodes[sibling] = block_t{};
+                for (size_t i = 1 - a; i < (size_t(1) << l); i += 2)
+                {
+                    xor_block(sum, nodes[i]);
+                }
+                nodes[sibling] = sum;
+            }
+            block_t leaf = tree_message[2 * depth];
+            for (size_t i = 0; i < tree_size; ++i)
+            {
+                xor_block(leaf, nodes[i]);
+            }
+            nodes[alphas[j]] = leaf;
+            e[j * tree_size + alphas[j]][0] = 1;
+        });
+
+    // r = C(w), c = C(e)
+    std::vector<block_t> r(parameters.number_ots);
+    std::vector<std::array<uint8_t, 1>> c(parameters.number_ots);
+    encode(r.data(), w.data(), r.size(), w.size(), receiver_counter_, number_threads, thread_pool);
+    encode(c.data(), e.data(), c.size(), e.size(), receiver_counter_, number_threads, thread_pool);
+
+    // H(i, r_i)
+    for_each_interval(thread_pool, number_threads, parameters.number_ots,
+        [this, &r, output](size_t begin, size_t end)
+        {
+            auto hash(Botan::Blake2b(8 * key_size));
+            for (size_t i = begin; i < end; ++i)
+            {
+                hash_block(hash, output[i].data(), receiver_counter_ + i, r[i]);
+            }
+        });
+
+    std::vector<bool> choices(parameters.number_ots);
+    for (size_t i = 0; i < parameters.number_ots; ++i)
+    {
+        choices[i] = c[i][0];
+    }
+    receiver_counter_ += parameters.number_ots;
+    return choices;
+}
+
+
+void SilentOT::send_random_into(ot_key_t* output, size_t number_ots,
+                                size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    for (size_t offset = 0; offset < number_ots; offset += max_batch_size)
+    {
+        const auto parameters = get_parameters(std::min(max_batch_size, number_ots - offset));
+        send_batch(output + 2 * offset, parameters, number_threads, thread_pool);
+    }
+}
+
+std::vector<bool> SilentOT::recv_random_into(ot_key_t* output, size_t number_ots,
+                                             size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    std::vector<bool> choices;
+    choices.reserve(number_ots);
+    for (size_t offset = 0; offset < number_ots; offset += max_batch_size)
+    {
+        const auto parameters = get_parameters(std::min(max_batch_size, number_ots - offset));
+        auto batch_choices = recv_batch(output + offset, parameters, number_threads, thread_pool);
+        choices.insert(choices.end(), batch_choices.cbegin(), batch_choices.cend());
+    }
+    return choices;
+}
+
+
+// The receiver sends d = c xor b for its random choices c and the given
+// choices b, the sender swaps its keys where d_i = 1.
+
+void SilentOT::send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    send_random_into(output, number_ots, number_threads, thread_pool);
+    if (number_ots == 0)
+        return;
+    bytes_t flips((number_ots + 7) / 8);
+    connection_.recv(flips.data(), flips.size());
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        if ((flips[i / 8] >> (i % 8)) & 1)
+            std::swap(output[2 * i], output[2 * i + 1]);
+    }
+}
+
+void SilentOT::recv_impl(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool)
+{
+    const auto number_ots = choices.size();
+    auto random_choices = recv_random_into(output, number_ots, number_threads, thread_pool);
+    if (number_ots == 0)
+        return;
+    bytes_t flips((number_ots + 7) / 8);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        flips[i / 8] |= static_cast<uint8_t>((random_choices[i] != choices[i]) << (i % 8));
+    }
+    connection_.send(flips.data(), flips.size());
+}
+
+std::pair<bytes_t, bytes_t> SilentOT::send()
+{
+    return send(1).front();
+}
+
+bytes_t SilentOT::recv(bool choice)
+{
+    return recv(std::vector<bool>{choice}).front();
+}
+
+void SilentOT::send_into(ot_key_t* output, size_t number_ots)
+{
+    send_impl(output, number_ots, 1, nullptr);
+}
+
+void SilentOT::recv_into(ot_key_t* output, const std::vector<bool>& choices)
+{
+    recv_impl(output, choices, 1, nullptr);
+}
+
+void SilentOT::parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    send_impl(output, number_ots, number_threads, &thread_pool);
+}
+
+void SilentOT::parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool)
+{
+    recv_impl(output, choices, number_threads, &thread_pool);
+}
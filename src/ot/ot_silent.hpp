@@ -0,0 +1,147 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef OT_SILENT_HPP
+#define OT_SILENT_HPP
+
+#include <vector>
+#include "ot.hpp"
+#include "network/connection.hpp"
+
+
+/**
+ * A silent random OT extension based on a pseudorandom correlation generator
+ * for the dual LPN problem with regular noise (Boyle, Couteau, Gilboa, Ishai,
+ * Kohl, Scholl (2019) https://eprint.iacr.org/2019/1159) and an
+ * expand-accumulate code (Boyle, Couteau, Gilboa, Ishai, Kohl, Resch, Scholl
+ * (2022) https://eprint.iacr.org/2022/1014).
+ *
+ * For every batch, the parties obtain a vector correlation w = v xor e * D of
+ * length code_size from GGM puncturable PRFs: the sender knows all leaves v
+ * and D, the receiver learns all leaves except one per tree, which makes up
+ * the sparse vector e.  Compressing both sides with the public code gives
+ * correlated OTs with random choice bits, which are hashed to random OTs.
+ *
+ * A batch needs noise_weight * log2(code_size / noise_weight) OTs from
+ * base_ot, which has to use the same connection, and sends 32 bytes for each
+ * of them.  Thus, the communication is sublinear in the number of OTs, if
+ * base_ot is an OT extension itself (e.g. an OTExtension on top of OT_HL17).
+ * The protocol is secure against semi-honest adversaries.
+ *
+ * send_random_into/recv_random_into produce OTs with random choice bits.
+ * send_into/recv_into additionally transfer one bit per OT to switch to the
+ * given choices.
+ */
+class SilentOT : public RandomOT
+{
+public:
+    SilentOT(Connection& connection, RandomOT& base_ot);
+
+    /**
+     * Send/receive for a single random OT.
+     */
+    std::pair<bytes_t, bytes_t> send() override;
+    bytes_t recv(bool) override;
+
+    /**
+     * Send/receive parts of the random OT protocol (batch version).
+     */
+    using RandomOT::send;
+    using RandomOT::recv;
+    using RandomOT::parallel_send;
+    using RandomOT::parallel_recv;
+    /**
+     * Batch send/receive writing the keys to caller-provided storage.
+     */
+    void send_into(ot_key_t* output, size_t number_ots) override;
+    void recv_into(ot_key_t* output, const std::vector<bool>& choices) override;
+    /**
+     * Parallelized version of batch send/receive.
+     * These methods will use the given thread pool.
+     */
+    using RandomOT::parallel_send_into;
+    using RandomOT::parallel_recv_into;
+    void parallel_send_into(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+    void parallel_recv_into(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool& thread_pool) override;
+
+    /**
+     * Batch send/receive of random OTs where the choice bits are chosen by
+     * the protocol and returned to the receiver.  If thread_pool is nullptr
+     * everything is computed in the calling thread.
+     */
+    void send_random_into(ot_key_t* output, size_t number_ots,
+                          size_t number_threads=1, boost::asio::thread_pool* thread_pool=nullptr);
+    std::vector<bool> recv_random_into(ot_key_t* output, size_t number_ots,
+                                       size_t number_threads=1, boost::asio::thread_pool* thread_pool=nullptr);
+
+    static constexpr size_t key_size = 16;
+    /**
+     * Number of punctured points (trees) per batch, which gives 128 bit
+     * security for a code with relative minimum distance 0.1 (the noise
+     * weight is -128 / log2(1 - 2 * 0.1)).
+     */
+    static constexpr size_t noise_weight = 400;
+    /**
+     * Each output of the code is the sum of this many accumulated entries.
+     */
+    static constexpr size_t expander_weight = 7;
+    /**
+     * Larger requests are split into batches of at most this many OTs.
+     */
+    static constexpr size_t max_batch_size = size_t(1) << 22;
+
+private:
+    using block_t = ot_key_t;
+
+    /**
+     * Parameters of a batch: number_trees GGM trees with 2^depth leaves each,
+     * i.e. the code maps code_size = number_trees * 2^depth entries to
+     * number_ots outputs, where code_size >= 2 * number_ots.
+     */
+    struct Parameters
+    {
+        size_t number_ots;
+        size_t number_trees;
+        size_t depth;
+        size_t code_size;
+    };
+    static Parameters get_parameters(size_t number_ots);
+
+    /**
+     * Implementation of the batch send/receive with the given choices.
+     */
+    void send_impl(ot_key_t* output, size_t number_ots, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    void recv_impl(ot_key_t* output, const std::vector<bool>& choices, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    /**
+     * One batch of random OTs.
+     */
+    void send_batch(ot_key_t* output, const Parameters& parameters, size_t number_threads, boost::asio::thread_pool* thread_pool);
+    std::vector<bool> recv_batch(ot_key_t* output, const Parameters& parameters, size_t number_threads, boost::asio::thread_pool* thread_pool);
+
+    Connection& connection_;
+    RandomOT& base_ot_;
+    uint64_t sender_counter_;
+    uint64_t receiver_counter_;
+};
+
+
+#endif // OT_SILENT_HPP
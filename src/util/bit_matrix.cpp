@@ -0,0 +1,85 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <cassert>
+#include "bit_matrix.hpp"
+
+
+static uint64_t load_64(const uint8_t* in)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        result |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return result;
+}
+
+static void store_64(uint8_t* out, uint64_t in)
+{
+    for (size_t i = 0; i < 8; ++i)
+    {
+        out[i] = static_cast<uint8_t>(in >> (8 * i));
+    }
+}
+
+// Transpose a 64x64 bit matrix in place, bit j of a[i] is entry (i, j).
+// In every round the off-diagonal blocks of size j x j are swapped.
+static void transpose_64x64(uint64_t a[64])
+{
+    uint64_t m = 0x00000000ffffffffULL;
+    for (size_t j = 32; j != 0; j >>= 1, m ^= (m << j))
+    {
+        for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j)
+        {
+            uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+void transpose_bit_matrix(uint8_t* output, const uint8_t* input,
+                          size_t rows, size_t cols)
+{
+    assert(rows % 64 == 0);
+    assert(cols % 64 == 0);
+    const size_t in_row_bytes = cols / 8;
+    const size_t out_row_bytes = rows / 8;
+
+    uint64_t block[64];
+    for (size_t rb = 0; rb < rows / 64; ++rb)
+    {
+        for (size_t cb = 0; cb < cols / 64; ++cb)
+        {
+            for (size_t i = 0; i < 64; ++i)
+            {
+                block[i] = load_64(input + (64 * rb + i) * in_row_bytes + 8 * cb);
+            }
+            transpose_64x64(block);
+            for (size_t i = 0; i < 64; ++i)
+            {
+                store_64(output + (64 * cb + i) * out_row_bytes + 8 * rb, block[i]);
+            }
+        }
+    }
+}
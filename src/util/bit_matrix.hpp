@@ -1,6 +1,6 @@
 // MIT License
 //
-// Copyright (c) 2017 Lennart Braun
+// Copyright (c) 2018 Lennart Braun
 //
 // Permission is hereby granted, free of charge, to any person obtaining a copy
 // of this software and associated documentation files (the "Software"), to deal
@@ -20,52 +20,21 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#ifndef QUEUE_HPP
-#define QUEUE_HPP
+#ifndef BIT_MATRIX_HPP
+#define BIT_MATRIX_HPP
 
-#include <iostream>
-#include <condition_variable>
-#include <mutex>
-#include <queue>
+#include <cstddef>
+#include <cstdint>
 
 /**
- * Locked queue for elements of type T
+ * Transpose a bit matrix.
+ *
+ * The input consists of `rows` rows with `cols` bits each, the output
+ * consists of `cols` rows with `rows` bits each.  Within a row, bit j is
+ * stored in byte j / 8 at position j % 8.  Both dimensions have to be
+ * multiples of 64.
  */
-template <typename T>
-class Queue
-{
-public:
+void transpose_bit_matrix(uint8_t* output, const uint8_t* input,
+                          size_t rows, size_t cols);
 
-    /**
-     * Adds a new element to the queue.
-     */
-    void enqueue(const T& item)
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        queue_.push(item);
-        cv_.notify_one();
-    }
-
-    /**
-     * Receives an element from the queue.
-     */
-    T dequeue()
-    {
-        std::unique_lock<std::mutex> lock(mutex_);
-        if (queue_.empty())
-        {
-            cv_.wait(lock, [this] { return !this->queue_.empty(); });
-        }
-        auto item = queue_.front();
-        queue_.pop();
-        lock.unlock();
-        return item;
-    }
-
-private:
-    std::queue<T> queue_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-};
-
-#endif // QUEUE_HPP
+#endif // BIT_MATRIX_HPP
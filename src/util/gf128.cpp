@@ -0,0 +1,184 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "gf128.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GF128_HAS_PCLMUL
+#include <immintrin.h>
+#endif
+
+
+static uint64_t load_64(const uint8_t* in)
+{
+    uint64_t result = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        result |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return result;
+}
+
+static void store_64(uint8_t* out, uint64_t in)
+{
+    for (size_t i = 0; i < 8; ++i)
+    {
+        out[i] = static_cast<uint8_t>(in >> (8 * i));
+    }
+}
+
+// Carry-less product of two 64-bit polynomials (without branches on the
+// data).
+static void clmul_64(uint64_t& lo, uint64_t& hi, uint64_t a, uint64_t b)
+{
+    lo = 0;
+    hi = 0;
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        const uint64_t mask = 0 - ((b >> i) & 1);
+        lo ^= (a << i) & mask;
+        hi ^= (i == 0 ? 0 : a >> (64 - i)) & mask;
+    }
+}
+
+static void mul_add_portable(gf128_sum_t& sum, const uint8_t* a, const uint8_t* b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i, a += 16, b += 16)
+    {
+        const uint64_t a0 = load_64(a);
+        const uint64_t a1 = load_64(a + 8);
+        const uint64_t b0 = load_64(b);
+        const uint64_t b1 = load_64(b + 8);
+        uint64_t lo, hi;
+        clmul_64(lo, hi, a0, b0);
+        sum[0] ^= lo;
+        sum[1] ^= hi;
+        clmul_64(lo, hi, a0, b1);
+        sum[1] ^= lo;
+        sum[2] ^= hi;
+        clmul_64(lo, hi, a1, b0);
+        sum[1] ^= lo;
+        sum[2] ^= hi;
+        clmul_64(lo, hi, a1, b1);
+        sum[2] ^= lo;
+        sum[3] ^= hi;
+    }
+}
+
+#if defined(GF128_HAS_PCLMUL)
+// The products are accumulated in three 128-bit registers and only combined
+// at the end.
+__attribute__((target("pclmul,sse2")))
+static void mul_add_pclmul(gf128_sum_t& sum, const uint8_t* a, const uint8_t* b, size_t n)
+{
+    __m128i lo = _mm_setzero_si128();
+    __m128i mid = _mm_setzero_si128();
+    __m128i hi = _mm_setzero_si128();
+    for (size_t i = 0; i < n; ++i, a += 16, b += 16)
+    {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        lo = _mm_xor_si128(lo, _mm_clmulepi64_si128(x, y, 0x00));
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(x, y, 0x01));
+        mid = _mm_xor_si128(mid, _mm_clmulepi64_si128(x, y, 0x10));
+        hi = _mm_xor_si128(hi, _mm_clmulepi64_si128(x, y, 0x11));
+    }
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+    alignas(16) uint64_t words[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(words), lo);
+    _mm_store_si128(reinterpret_cast<__m128i*>(words + 2), hi);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        sum[i] ^= words[i];
+    }
+}
+#endif
+
+static GF128Impl& current_impl()
+{
+    static GF128Impl impl = gf128_impl_supported(GF128Impl::pclmul) ? GF128Impl::pclmul : GF128Impl::portable;
+    return impl;
+}
+
+bool gf128_impl_supported(GF128Impl impl)
+{
+    switch (impl)
+    {
+        case GF128Impl::portable:
+            return true;
+#if defined(GF128_HAS_PCLMUL)
+        case GF128Impl::pclmul:
+            return __builtin_cpu_supports("pclmul");
+#endif
+        default:
+            return false;
+    }
+}
+
+GF128Impl gf128_get_impl()
+{
+    return current_impl();
+}
+
+bool gf128_set_impl(GF128Impl impl)
+{
+    if (!gf128_impl_supported(impl))
+        return false;
+    current_impl() = impl;
+    return true;
+}
+
+
+void gf128_mul_add(gf128_sum_t& sum, const uint8_t* a, const uint8_t* b, size_t n)
+{
+#if defined(GF128_HAS_PCLMUL)
+    if (current_impl() == GF128Impl::pclmul)
+    {
+        mul_add_pclmul(sum, a, b, n);
+        return;
+    }
+#endif
+    mul_add_portable(sum, a, b, n);
+}
+
+// X^128 = X^7 + X^2 + X + 1, so the upper half h is folded into the lower
+// one as h * (X^7 + X^2 + X + 1).  The at most 7 bits which overflow again
+// are folded a second time.
+void gf128_reduce(uint8_t* out, const gf128_sum_t& sum)
+{
+    const uint64_t h0 = sum[2];
+    const uint64_t h1 = sum[3];
+    const uint64_t overflow = (h1 >> 63) ^ (h1 >> 62) ^ (h1 >> 57);
+    uint64_t lo = sum[0] ^ h0 ^ (h0 << 1) ^ (h0 << 2) ^ (h0 << 7);
+    const uint64_t hi = sum[1] ^ h1 ^ ((h1 << 1) | (h0 >> 63)) ^ ((h1 << 2) | (h0 >> 62)) ^ ((h1 << 7) | (h0 >> 57));
+    lo ^= overflow ^ (overflow << 1) ^ (overflow << 2) ^ (overflow << 7);
+    store_64(out, lo);
+    store_64(out + 8, hi);
+}
+
+void gf128_mul(uint8_t* out, const uint8_t* a, const uint8_t* b)
+{
+    gf128_sum_t sum{};
+    gf128_mul_add(sum, a, b, 1);
+    gf128_reduce(out, sum);
+}
@@ -0,0 +1,72 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GF128_HPP
+#define GF128_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Arithmetic in GF(2^128) = GF(2)[X] / (X^128 + X^7 + X^2 + X + 1).
+ *
+ * An element is stored in 16 bytes, bit i of byte j is the coefficient of
+ * X^(8j + i).  This is the layout of the rows of a transposed bit matrix.
+ */
+
+/**
+ * Unreduced polynomial of degree < 255, least significant word first.
+ */
+using gf128_sum_t = std::array<uint64_t, 4>;
+
+/**
+ * out = a * b
+ */
+void gf128_mul(uint8_t* out, const uint8_t* a, const uint8_t* b);
+
+/**
+ * sum += a[0] * b[0] + ... + a[n-1] * b[n-1] without reduction, where the n
+ * elements of a and b are stored consecutively.
+ */
+void gf128_mul_add(gf128_sum_t& sum, const uint8_t* a, const uint8_t* b, size_t n);
+
+/**
+ * Reduce sum to an element.
+ */
+void gf128_reduce(uint8_t* out, const gf128_sum_t& sum);
+
+/**
+ * Implementations of the multiplication.  The best one supported by the CPU
+ * is used by default.  gf128_set_impl is meant for tests and benchmarks, it
+ * is not thread safe and returns false if the CPU does not support impl.
+ */
+enum class GF128Impl
+{
+    portable,
+    pclmul,
+};
+bool gf128_impl_supported(GF128Impl impl);
+GF128Impl gf128_get_impl();
+bool gf128_set_impl(GF128Impl impl);
+
+#endif // GF128_HPP
@@ -64,6 +64,12 @@ std::istream& operator>>(std::istream &is, OT_Protocol &ot)
         ot = OT_Protocol::CO15;
     else if (token == "hl17")
         ot = OT_Protocol::HL17;
+    else if (token == "iknp03" || token == "iknp")
+        ot = OT_Protocol::IKNP03;
+    else if (token == "kos15" || token == "kos")
+        ot = OT_Protocol::KOS15;
+    else if (token == "silent")
+        ot = OT_Protocol::SILENT;
     else
         throw po::invalid_option_value(token);
     return is;
@@ -79,6 +85,15 @@ std::ostream& operator<<(std::ostream &os, const OT_Protocol &ot)
         case OT_Protocol::HL17:
             os << "HL17";
             break;
+        case OT_Protocol::IKNP03:
+            os << "IKNP03";
+            break;
+        case OT_Protocol::KOS15:
+            os << "KOS15";
+            break;
+        case OT_Protocol::SILENT:
+            os << "SILENT";
+            break;
     }
     return os;
 }
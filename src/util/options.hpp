@@ -44,6 +44,9 @@ enum class OT_Protocol
 {
     CO15,
     HL17,
+    IKNP03,
+    KOS15,
+    SILENT,
 };
 
 /**
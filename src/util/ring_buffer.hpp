@@ -0,0 +1,425 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace detail
+{
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Spin-then-park waiting for one side of a ring buffer.
+ *
+ * A waiter first spins for a while, then yields and finally blocks on a
+ * condition variable.  The number of spin iterations adapts: it grows when
+ * spinning was successful and shrinks when the waiter had to park anyway.
+ * The other side only takes the mutex if somebody is actually parked.
+ */
+class Parking
+{
+public:
+    /**
+     * Wait until attempt() returns true.
+     */
+    template <typename F>
+    void wait(F&& attempt)
+    {
+        const auto spin_limit = spin_limit_.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < spin_limit; ++i)
+        {
+            if (attempt())
+            {
+                if (i > spin_limit / 2 && spin_limit < max_spin)
+                    spin_limit_.store(2 * spin_limit, std::memory_order_relaxed);
+                return;
+            }
+            cpu_relax();
+        }
+        for (uint32_t i = 0; i < yield_iterations; ++i)
+        {
+            if (attempt())
+                return;
+            std::this_thread::yield();
+        }
+        if (spin_limit > min_spin)
+            spin_limit_.store(spin_limit / 2, std::memory_order_relaxed);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiters_.fetch_add(1, std::memory_order_relaxed);
+        // pairs with the fence in notify: either notify sees the waiter or
+        // the attempt sees the new state
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv_.wait(lock, attempt);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wake up parked waiters.  To be called after the state has changed.
+     */
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            cv_.notify_all();
+        }
+    }
+
+private:
+    static constexpr uint32_t min_spin = 16;
+    static constexpr uint32_t max_spin = 1 << 14;
+    static constexpr uint32_t yield_iterations = 16;
+
+    std::atomic<uint32_t> spin_limit_{1024};
+    std::atomic<uint32_t> waiters_{0};
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+};
+
+inline size_t round_up_capacity(size_t capacity)
+{
+    size_t result = 2;
+    while (result < capacity)
+        result *= 2;
+    return result;
+}
+
+}  // namespace detail
+
+/**
+ * Bounded lock-free queue for a single producer and a single consumer
+ * thread.
+ *
+ * Elements are moved in and out, so T may be move-only; it has to be default
+ * constructible.  The capacity is rounded up to a power of two.  Batched
+ * operations publish all elements with a single atomic store.
+ */
+template <typename T>
+class SPSCRingBuffer
+{
+public:
+    explicit SPSCRingBuffer(size_t capacity = 1024)
+        : mask_(detail::round_up_capacity(capacity) - 1),
+          slots_(std::make_unique<T[]>(mask_ + 1)),
+          not_empty_(), not_full_()
+    {
+    }
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    /**
+     * Move up to n elements from items into the queue without blocking.
+     * Returns the number of elements pushed.
+     */
+    size_t try_push_batch(T* items, size_t n)
+    {
+        auto pushed = push_some(items, n);
+        if (pushed > 0)
+            not_empty_.notify();
+        return pushed;
+    }
+
+    /**
+     * Move n elements from items into the queue.  Blocks while it is full.
+     */
+    void push_batch(T* items, size_t n)
+    {
+        size_t pushed = try_push_batch(items, n);
+        while (pushed < n)
+        {
+            not_full_.wait([&]
+                {
+                    auto k = push_some(items + pushed, n - pushed);
+                    pushed += k;
+                    return k > 0;
+                });
+            not_empty_.notify();
+        }
+    }
+
+    bool try_push(T&& item)
+    {
+        return try_push_batch(&item, 1) == 1;
+    }
+
+    void push(T&& item)
+    {
+        push_batch(&item, 1);
+    }
+
+    /**
+     * Move up to max elements from the queue to out without blocking.
+     * Returns the number of elements popped.
+     */
+    size_t try_pop_batch(T* out, size_t max)
+    {
+        auto popped = pop_some(out, max);
+        if (popped > 0)
+            not_full_.notify();
+        return popped;
+    }
+
+    /**
+     * Move between 1 and max elements from the queue to out.  Blocks while
+     * it is empty.
+     */
+    size_t pop_batch(T* out, size_t max)
+    {
+        size_t popped = 0;
+        not_empty_.wait([&] { return (popped = pop_some(out, max)) > 0; });
+        not_full_.notify();
+        return popped;
+    }
+
+    bool try_pop(T& item)
+    {
+        return try_pop_batch(&item, 1) == 1;
+    }
+
+    T pop()
+    {
+        T item;
+        pop_batch(&item, 1);
+        return item;
+    }
+
+private:
+    size_t push_some(T* items, size_t n)
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ + n > capacity())
+            cached_head_ = head_.load(std::memory_order_acquire);
+        n = std::min(n, capacity() - (tail - cached_head_));
+        for (size_t i = 0; i < n; ++i)
+            slots_[(tail + i) & mask_] = std::move(items[i]);
+        if (n > 0)
+            tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    size_t pop_some(T* out, size_t max)
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max)
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        auto n = std::min(max, cached_tail_ - head);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = std::move(slots_[(head + i) & mask_]);
+        if (n > 0)
+            head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<T[]> slots_;
+    // consumer side
+    alignas(64) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+    // producer side
+    alignas(64) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+    alignas(64) detail::Parking not_empty_;
+    detail::Parking not_full_;
+};
+
+/**
+ * Bounded lock-free queue for any number of producer and consumer threads
+ * (D. Vyukov's bounded MPMC queue).
+ *
+ * Same interface as SPSCRingBuffer.  Batched operations move the elements
+ * one by one, but wake up the other side only once.
+ */
+template <typename T>
+class MPMCRingBuffer
+{
+public:
+    explicit MPMCRingBuffer(size_t capacity = 1024)
+        : mask_(detail::round_up_capacity(capacity) - 1),
+          cells_(std::make_unique<Cell[]>(mask_ + 1)),
+          not_empty_(), not_full_()
+    {
+        for (size_t i = 0; i <= mask_; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    MPMCRingBuffer(const MPMCRingBuffer&) = delete;
+    MPMCRingBuffer& operator=(const MPMCRingBuffer&) = delete;
+
+    size_t capacity() const
+    {
+        return mask_ + 1;
+    }
+
+    size_t try_push_batch(T* items, size_t n)
+    {
+        size_t pushed = 0;
+        while (pushed < n && push_one(items[pushed]))
+            ++pushed;
+        if (pushed > 0)
+            not_empty_.notify();
+        return pushed;
+    }
+
+    void push_batch(T* items, size_t n)
+    {
+        size_t pushed = try_push_batch(items, n);
+        while (pushed < n)
+        {
+            not_full_.wait([&] { return push_one(items[pushed]); });
+            ++pushed;
+            pushed += try_push_batch(items + pushed, n - pushed);
+            not_empty_.notify();
+        }
+    }
+
+    bool try_push(T&& item)
+    {
+        return try_push_batch(&item, 1) == 1;
+    }
+
+    void push(T&& item)
+    {
+        push_batch(&item, 1);
+    }
+
+    size_t try_pop_batch(T* out, size_t max)
+    {
+        size_t popped = 0;
+        while (popped < max && pop_one(out[popped]))
+            ++popped;
+        if (popped > 0)
+            not_full_.notify();
+        return popped;
+    }
+
+    size_t pop_batch(T* out, size_t max)
+    {
+        if (max == 0)
+            return 0;
+        not_empty_.wait([&] { return pop_one(out[0]); });
+        size_t popped = 1;
+        while (popped < max && pop_one(out[popped]))
+            ++popped;
+        not_full_.notify();
+        return popped;
+    }
+
+    bool try_pop(T& item)
+    {
+        return try_pop_batch(&item, 1) == 1;
+    }
+
+    T pop()
+    {
+        T item;
+        pop_batch(&item, 1);
+        return item;
+    }
+
+private:
+    struct alignas(64) Cell
+    {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    bool push_one(T& item)
+    {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - pos);
+            if (diff == 0)
+            {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+        cell->value = std::move(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop_one(T& item)
+    {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells_[pos & mask_];
+            auto sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+            if (diff == 0)
+            {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+        item = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+    alignas(64) detail::Parking not_empty_;
+    detail::Parking not_full_;
+};
+
+#endif // RING_BUFFER_HPP
@@ -20,8 +20,18 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
-#include <future>
-#include <boost/asio/post.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 #include "threading.hpp"
 
 std::pair<size_t, size_t> get_interval(size_t num_stuff, size_t num_threads, size_t thread_id)
@@ -35,23 +45,191 @@ std::pair<size_t, size_t> get_interval(size_t num_stuff, size_t num_threads, siz
     return {start, end};
 }
 
-void compute(boost::asio::thread_pool& thread_pool, size_t num_stuff, size_t num_threads, std::function<void(size_t index)> func)
+
+namespace
+{
+
+std::mutex global_config_mutex;
+GlobalThreadPoolConfig global_config;
+bool global_pool_created = false;
+
+GlobalThreadPoolConfig take_global_config()
+{
+    std::lock_guard<std::mutex> lock(global_config_mutex);
+    global_pool_created = true;
+    return global_config;
+}
+
+#ifdef __linux__
+/**
+ * Parse a cpu list like "0-3,8,10-11".
+ */
+std::vector<int> parse_cpu_list(const std::string& list)
 {
-    std::vector<std::promise<void>> promises(num_threads);
-    for (size_t thread_id = 0; thread_id < num_threads; ++thread_id)
+    std::vector<int> cpus;
+    std::istringstream is(list);
+    std::string range;
+    while (std::getline(is, range, ','))
     {
-        auto interval = get_interval(num_stuff, num_threads, thread_id);
-        boost::asio::post(thread_pool, [interval, func, &promises, thread_id]
-            {
-                for (size_t i = interval.first; i < interval.second; ++i)
-                {
-                    func(i);
-                }
-                promises[thread_id].set_value();
-            });
+        if (range.empty() || range == "\n")
+            continue;
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+#endif
+
+/**
+ * Cores that the pool threads may run on.  Empty if unknown.
+ */
+std::vector<int> available_cpus(int numa_node)
+{
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return cpus;
+    if (numa_node >= 0)
+    {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+        std::string list;
+        if (!std::getline(file, list))
+            throw std::invalid_argument("unknown NUMA node " + std::to_string(numa_node));
+        for (auto cpu : parse_cpu_list(list))
+        {
+            if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        }
+        if (cpus.empty())
+            throw std::invalid_argument("no usable cores on NUMA node " + std::to_string(numa_node));
     }
-    for (size_t thread_id = 0; thread_id < num_threads; ++thread_id)
+    else
     {
-        promises[thread_id].get_future().get();
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &allowed))
+                cpus.push_back(cpu);
+        }
     }
+#else
+    if (numa_node >= 0)
+        throw std::invalid_argument("NUMA placement is not supported on this platform");
+#endif
+    return cpus;
+}
+
+/**
+ * Restrict the calling thread to the given cores.  Returns 0 on success or
+ * an error number.
+ */
+int set_affinity(const int* cpus, size_t number_cpus)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < number_cpus; ++i)
+        CPU_SET(cpus[i], &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+    (void)number_cpus;
+    return 0;
+#endif
+}
+
+/**
+ * Thread pool whose threads are placed according to a GlobalThreadPoolConfig.
+ */
+class GlobalThreadPool
+{
+public:
+    explicit GlobalThreadPool(const GlobalThreadPoolConfig& config)
+        : GlobalThreadPool(config, available_cpus(config.numa_node))
+    {
+    }
+
+    ~GlobalThreadPool()
+    {
+        thread_pool_.join();
+    }
+
+    GlobalThreadPool(const GlobalThreadPool&) = delete;
+    GlobalThreadPool& operator=(const GlobalThreadPool&) = delete;
+
+    boost::asio::thread_pool& get()
+    {
+        return thread_pool_;
+    }
+
+private:
+    GlobalThreadPool(const GlobalThreadPoolConfig& config, const std::vector<int>& cpus)
+        : number_threads_(config.number_threads != 0 ? config.number_threads
+                          : std::max<size_t>(1, cpus.empty() ? std::thread::hardware_concurrency() : cpus.size())),
+          thread_pool_(number_threads_)
+    {
+        if (cpus.empty() || (!config.pin_threads && config.numa_node < 0))
+            return;
+        // Every task blocks until all threads have picked up one of them, so
+        // that each thread places itself exactly once.  Threads may still be
+        // leaving the barrier when the constructor returns, hence its state
+        // is reference counted.
+        struct Barrier
+        {
+            Barrier() : mutex(), cv(), arrived(0), error(0) {}
+            std::mutex mutex;
+            std::condition_variable cv;
+            size_t arrived;
+            int error;
+        };
+        auto barrier = std::make_shared<Barrier>();
+        auto shared_cpus = std::make_shared<const std::vector<int>>(cpus);
+        for (size_t i = 0; i < number_threads_; ++i)
+        {
+            boost::asio::post(thread_pool_,
+                [barrier, shared_cpus, pin = config.pin_threads, number_threads = number_threads_]
+                {
+                    const auto& cpus = *shared_cpus;
+                    std::unique_lock<std::mutex> lock(barrier->mutex);
+                    auto index = barrier->arrived++;
+                    auto error = pin ? set_affinity(&cpus[index % cpus.size()], 1)
+                                     : set_affinity(cpus.data(), cpus.size());
+                    if (error != 0 && barrier->error == 0)
+                        barrier->error = error;
+                    if (barrier->arrived == number_threads)
+                        barrier->cv.notify_all();
+                    else
+                        barrier->cv.wait(lock, [&] { return barrier->arrived == number_threads; });
+                });
+        }
+        std::unique_lock<std::mutex> lock(barrier->mutex);
+        barrier->cv.wait(lock, [&] { return barrier->arrived == number_threads_; });
+        if (barrier->error != 0)
+            throw std::system_error(barrier->error, std::generic_category(),
+                                    "failed to set the affinity of the global thread pool");
+    }
+
+    size_t number_threads_;
+    boost::asio::thread_pool thread_pool_;
+};
+
+}  // namespace
+
+void configure_global_thread_pool(const GlobalThreadPoolConfig& config)
+{
+    std::lock_guard<std::mutex> lock(global_config_mutex);
+    if (global_pool_created)
+        throw std::logic_error("global thread pool already in use");
+    global_config = config;
+}
+
+boost::asio::thread_pool& global_thread_pool()
+{
+    // destroyed, and thus joined, at exit
+    static GlobalThreadPool thread_pool(take_global_config());
+    return thread_pool.get();
 }
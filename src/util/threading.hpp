@@ -23,13 +23,257 @@
 #ifndef THREADING_HPP
 #define THREADING_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
-#include <functional>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <utility>
+#include <boost/asio/post.hpp>
 #include <boost/asio/thread_pool.hpp>
 
 std::pair<size_t, size_t> get_interval(size_t num_stuff, size_t num_threads, size_t thread_id);
 
-void compute(boost::asio::thread_pool& thread_pool, size_t num_stuff, size_t num_threads, std::function<void(size_t index)> func);
+/**
+ * Configuration of the process-wide thread pool.
+ */
+struct GlobalThreadPoolConfig
+{
+    /** Number of threads, 0 for one per available core. */
+    size_t number_threads = 0;
+    /** Pin each thread to a single core. */
+    bool pin_threads = true;
+    /** Only use the cores of this NUMA node, -1 for all available cores. */
+    int numa_node = -1;
+};
+
+/**
+ * Set the configuration of the global thread pool.  Has to be called before
+ * its first use, otherwise std::logic_error is thrown.
+ */
+void configure_global_thread_pool(const GlobalThreadPoolConfig& config);
+
+/**
+ * Process-wide thread pool.  It is created on first use and joined at process
+ * exit.
+ */
+boost::asio::thread_pool& global_thread_pool();
+
+namespace detail
+{
+
+/**
+ * Shared state of a parallel_for.  The chunks are initially distributed
+ * evenly over the workers.  Each worker has its own counter which it and
+ * any thief advance atomically to claim chunks.  run_chunk is only invoked
+ * while unclaimed chunks remain, i.e. while the caller still waits.
+ */
+template <typename R>
+struct ParallelForState
+{
+    struct alignas(64) Range
+    {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+
+    ParallelForState(R run_chunk, size_t number_chunks, size_t number_workers)
+        : run_chunk(std::move(run_chunk)), ranges(new Range[number_workers]), number_workers(number_workers),
+          number_chunks(number_chunks), chunks_done(0), mutex(), cv(), error()
+    {
+        for (size_t w = 0; w < number_workers; ++w)
+        {
+            auto interval = get_interval(number_chunks, number_workers, w);
+            ranges[w].next.store(interval.first, std::memory_order_relaxed);
+            ranges[w].end = interval.second;
+        }
+    }
+
+    /**
+     * Process the chunks of worker w, then steal from the other workers.
+     */
+    void work(size_t w)
+    {
+        for (size_t i = 0; i < number_workers; ++i)
+        {
+            auto& range = ranges[(w + i) % number_workers];
+            for (auto c = range.next.fetch_add(1, std::memory_order_relaxed); c < range.end;
+                 c = range.next.fetch_add(1, std::memory_order_relaxed))
+            {
+                try
+                {
+                    run_chunk(c);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                if (chunks_done.fetch_add(1, std::memory_order_acq_rel) + 1 == number_chunks)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    cv.notify_all();
+                }
+            }
+        }
+    }
+
+    /**
+     * Wait until all chunks are processed and rethrow the first exception.
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return chunks_done.load(std::memory_order_acquire) == number_chunks; });
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    R run_chunk;
+    std::unique_ptr<Range[]> ranges;
+    const size_t number_workers;
+    const size_t number_chunks;
+    std::atomic<size_t> chunks_done;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::exception_ptr error;
+};
+
+}  // namespace detail
+
+/**
+ * Call func(begin, end) for consecutive chunks of [0, num_stuff) with at most
+ * chunk_size elements each, using num_threads workers.  The calling thread is
+ * one of the workers, the others run in the thread pool.  Workers that run
+ * out of chunks steal chunks from the others, so that slow chunks or busy
+ * pool threads do not delay the whole computation.  Blocks until all chunks
+ * are done and rethrows the first exception thrown by func.
+ */
+template <typename F>
+void parallel_for(boost::asio::thread_pool& thread_pool, size_t num_stuff, size_t num_threads, size_t chunk_size, F&& func)
+{
+    if (num_stuff == 0)
+        return;
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    const auto number_chunks = (num_stuff + chunk_size - 1) / chunk_size;
+    const auto number_workers = std::min(std::max<size_t>(num_threads, 1), number_chunks);
+
+    auto run_chunk = [&func, num_stuff, chunk_size](size_t c)
+    {
+        auto begin = c * chunk_size;
+        func(begin, std::min(num_stuff, begin + chunk_size));
+    };
+
+    if (number_workers == 1)
+    {
+        for (size_t c = 0; c < number_chunks; ++c)
+        {
+            run_chunk(c);
+        }
+        return;
+    }
+
+    // Workers which start after all chunks are done only touch the shared
+    // state, hence it is reference counted.
+    auto state = std::make_shared<detail::ParallelForState<decltype(run_chunk)>>(
+        run_chunk, number_chunks, number_workers);
+    for (size_t w = 1; w < number_workers; ++w)
+    {
+        boost::asio::post(thread_pool, [state, w] { state->work(w); });
+    }
+    state->work(0);
+    state->wait();
+}
+
+/**
+ * Default chunk size for parallel_for: a few chunks per thread, so that
+ * stealing can balance the load.
+ */
+inline size_t default_chunk_size(size_t num_stuff, size_t num_threads)
+{
+    const size_t chunks_per_thread = 4;
+    return std::max<size_t>(1, num_stuff / (chunks_per_thread * std::max<size_t>(num_threads, 1)));
+}
+
+/**
+ * Call func(index) for all indices in [0, num_stuff).
+ */
+template <typename F>
+void compute(boost::asio::thread_pool& thread_pool, size_t num_stuff, size_t num_threads, F&& func)
+{
+    parallel_for(thread_pool, num_stuff, num_threads, default_chunk_size(num_stuff, num_threads),
+        [&func](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                func(i);
+            }
+        });
+}
+
+/**
+ * Call func(begin, end) on a partition of [0, num_stuff) into intervals of at
+ * most chunk_size elements (0 selects default_chunk_size).
+ */
+template <typename F>
+void compute_intervals(boost::asio::thread_pool& thread_pool, size_t num_stuff, size_t num_threads, F&& func,
+                       size_t chunk_size = 0)
+{
+    if (chunk_size == 0)
+        chunk_size = default_chunk_size(num_stuff, num_threads);
+    parallel_for(thread_pool, num_stuff, num_threads, chunk_size, std::forward<F>(func));
+}
+
+/**
+ * Variants of compute and compute_intervals for code that optionally runs
+ * in parallel: if thread_pool is nullptr, everything is done in the calling
+ * thread.
+ *
+ * Call func(i) for all i in [0, n).
+ */
+template <typename F>
+void for_each_index(boost::asio::thread_pool* thread_pool, size_t number_threads, size_t n, F&& func)
+{
+    if (thread_pool == nullptr)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            func(i);
+        }
+    }
+    else
+    {
+        compute(*thread_pool, n, number_threads, std::forward<F>(func));
+    }
+}
+
+/**
+ * Call func(begin', end') on a partition of [begin, end).
+ */
+template <typename F>
+void for_each_interval(boost::asio::thread_pool* thread_pool, size_t number_threads, size_t begin, size_t end, F&& func)
+{
+    if (thread_pool == nullptr)
+    {
+        func(begin, end);
+    }
+    else
+    {
+        compute_intervals(*thread_pool, end - begin, number_threads,
+            [begin, &func](size_t b, size_t e) { func(begin + b, begin + e); });
+    }
+}
+
+/**
+ * Call func(begin, end) on a partition of [0, n).
+ */
+template <typename F>
+void for_each_interval(boost::asio::thread_pool* thread_pool, size_t number_threads, size_t n, F&& func)
+{
+    for_each_interval(thread_pool, number_threads, 0, n, std::forward<F>(func));
+}
 
 #endif // THREADING_HPP
@@ -23,24 +23,16 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
-#include <fstream>
-#include <limits>
 #include <map>
 #include <sstream>
-#include <stdexcept>
+#include "curve25519/util.h"
 #include "util.hpp"
 
 
 bytes_t random_bytes(size_t n)
 {
-    if (n > std::numeric_limits<std::streamsize>::max())
-    {
-        throw std::range_error("random_bytes: cannot cast size_t to streamsize");
-    }
-    std::ifstream urandom("/dev/urandom", std::ios::binary);
     bytes_t result(n);
-    urandom.read(reinterpret_cast<char*>(result.data()),
-                 static_cast<std::streamsize>(result.size()));
+    random_bytes(result.data(), result.size());
     return result;
 }
 
@@ -54,16 +46,21 @@ static const std::map<char, uint8_t> hex2val{
     {'A', 10}, {'B', 11}, {'C', 12}, {'D', 13}, {'E', 14}, {'F', 15}};
 
 std::string hexlify(const bytes_t &data, bool upper)
+{
+    return hexlify(data.data(), data.size(), upper);
+}
+
+std::string hexlify(const uint8_t *data, size_t size, bool upper)
 {
 
     auto &digits{upper ? hex_digits_upper : hex_digits};
     std::string hex;
-    hex.reserve(2 * data.size());
+    hex.reserve(2 * size);
 
-    for (auto &b : data)
+    for (size_t i = 0; i < size; ++i)
     {
-        hex.push_back(digits[(b >> 4) & 0x0f]);
-        hex.push_back(digits[b & 0x0f]);
+        hex.push_back(digits[(data[i] >> 4) & 0x0f]);
+        hex.push_back(digits[data[i] & 0x0f]);
     }
 
     return hex;
@@ -43,6 +43,7 @@ bytes_t random_bytes(size_t n);
  * Encode bytes in hexadecimal representation
  */
 std::string hexlify(const bytes_t &data, bool upper=false);
+std::string hexlify(const uint8_t *data, size_t size, bool upper=false);
 /**
  * Decode hexadecimal into bytes
  */
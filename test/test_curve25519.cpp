@@ -65,3 +65,164 @@ TEST(Curve25519_Test, ToFromBytesRandom)
 
     ASSERT_EQ(buf0, buf1);
 }
+
+TEST(Curve25519_Test, FromBytesBatch)
+{
+    const size_t n = 10;
+    std::vector<std::array<uint8_t, 32>> encoded(n);
+    for (auto& buf : encoded)
+    {
+        std::array<uint8_t, 32> sc;
+        curve25519::sc_random(sc.data());
+        curve25519::ge_p3 S;
+        curve25519::x25519_ge_scalarmult_base(&S, sc.data());
+        curve25519::ge_p3_tobytes(buf.data(), &S);
+    }
+
+    std::vector<curve25519::ge_p3> points(n);
+    auto ret = curve25519::x25519_ge_frombytes_vartime_batch(points.data(), encoded[0].data(), n);
+    ASSERT_EQ(ret, 1);
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::array<uint8_t, 32> buf;
+        curve25519::ge_p3_tobytes(buf.data(), &points[i]);
+        ASSERT_EQ(buf, encoded[i]);
+    }
+
+    // find an encoding which is not on the curve
+    std::array<uint8_t, 32> invalid{};
+    curve25519::ge_p3 tmp;
+    do
+    {
+        invalid[0]++;
+    } while (curve25519::x25519_ge_frombytes_vartime(&tmp, invalid.data()) == 1);
+    encoded[n / 2] = invalid;
+    ret = curve25519::x25519_ge_frombytes_vartime_batch(points.data(), encoded[0].data(), n);
+    ASSERT_EQ(ret, 0);
+}
+
+TEST(Curve25519_Test, ToBytesBatch)
+{
+    // more than one chunk of the batch inversion
+    const size_t n = 300;
+    std::vector<curve25519::ge_p3> points(n);
+    std::vector<curve25519::ge_p2> points_p2(n);
+    std::vector<std::array<uint8_t, 32>> expected(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        std::array<uint8_t, 32> sc;
+        curve25519::sc_random(sc.data());
+        curve25519::x25519_ge_scalarmult_base(&points[i], sc.data());
+        curve25519::ge_p3_tobytes(expected[i].data(), &points[i]);
+        curve25519::x25519_ge_scalarmult(&points_p2[i], sc.data(), &points[i]);
+    }
+
+    std::vector<std::array<uint8_t, 32>> encoded(n);
+    curve25519::ge_p3_tobytes_batch(encoded[0].data(), points.data(), n);
+    ASSERT_EQ(encoded, expected);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        curve25519::x25519_ge_tobytes(expected[i].data(), &points_p2[i]);
+    }
+    curve25519::x25519_ge_tobytes_batch(encoded[0].data(), points_p2.data(), n);
+    ASSERT_EQ(encoded, expected);
+}
+
+static void check_scalarmult_batch()
+{
+    // cover full groups of lanes as well as the remainders
+    for (size_t n = 0; n < 20; ++n)
+    {
+        std::vector<std::array<uint8_t, 32>> scalars(n);
+        std::vector<curve25519::ge_p3> points(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::array<uint8_t, 32> sc;
+            curve25519::sc_random(sc.data());
+            curve25519::x25519_ge_scalarmult_base(&points[i], sc.data());
+            curve25519::sc_random(scalars[i].data());
+        }
+
+        std::vector<curve25519::ge_p3> base_batch(n);
+        std::vector<curve25519::ge_p2> var_batch(n);
+        curve25519::x25519_ge_scalarmult_base_batch(base_batch.data(), scalars.data()->data(), n);
+        curve25519::x25519_ge_scalarmult_batch(var_batch.data(), scalars.data()->data(), points.data(), n);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            std::array<uint8_t, 32> expected, actual;
+
+            curve25519::ge_p3 base;
+            curve25519::x25519_ge_scalarmult_base(&base, scalars[i].data());
+            curve25519::ge_p3_tobytes(expected.data(), &base);
+            curve25519::ge_p3_tobytes(actual.data(), &base_batch[i]);
+            ASSERT_EQ(actual, expected);
+
+            // T is consistent with X, Y, Z
+            curve25519::ge_cached cached;
+            curve25519::x25519_ge_p3_to_cached(&cached, &base);
+            curve25519::ge_p1p1 sum_p1p1;
+            curve25519::ge_p2 sum;
+            curve25519::x25519_ge_add(&sum_p1p1, &base, &cached);
+            curve25519::x25519_ge_p1p1_to_p2(&sum, &sum_p1p1);
+            curve25519::x25519_ge_tobytes(expected.data(), &sum);
+            curve25519::x25519_ge_add(&sum_p1p1, &base_batch[i], &cached);
+            curve25519::x25519_ge_p1p1_to_p2(&sum, &sum_p1p1);
+            curve25519::x25519_ge_tobytes(actual.data(), &sum);
+            ASSERT_EQ(actual, expected);
+
+            curve25519::ge_p2 var;
+            curve25519::x25519_ge_scalarmult(&var, scalars[i].data(), &points[i]);
+            curve25519::x25519_ge_tobytes(expected.data(), &var);
+            curve25519::x25519_ge_tobytes(actual.data(), &var_batch[i]);
+            ASSERT_EQ(actual, expected);
+        }
+    }
+}
+
+TEST(Curve25519_Test, ScalarmultBatch)
+{
+    const auto default_impl = curve25519::x25519_get_impl();
+    for (auto impl : {curve25519::X25519_IMPL_SCALAR,
+                      curve25519::X25519_IMPL_AVX2,
+                      curve25519::X25519_IMPL_AVX512IFMA})
+    {
+        if (!curve25519::x25519_set_impl(impl))
+            continue;
+        SCOPED_TRACE(impl);
+        check_scalarmult_batch();
+    }
+    curve25519::x25519_set_impl(default_impl);
+}
+
+TEST(Curve25519_Test, AddCmov)
+{
+    std::array<uint8_t, 32> sc;
+    curve25519::ge_p3 P, Q;
+    curve25519::sc_random(sc.data());
+    curve25519::x25519_ge_scalarmult_base(&P, sc.data());
+    curve25519::sc_random(sc.data());
+    curve25519::x25519_ge_scalarmult_base(&Q, sc.data());
+    curve25519::ge_cached Q_cached;
+    curve25519::x25519_ge_p3_to_cached(&Q_cached, &Q);
+
+    std::array<uint8_t, 32> expected;
+    std::array<uint8_t, 32> actual;
+    curve25519::ge_p3 R;
+
+    curve25519::x25519_ge_add_cmov(&R, &P, &Q_cached, 0);
+    curve25519::ge_p3_tobytes(expected.data(), &P);
+    curve25519::ge_p3_tobytes(actual.data(), &R);
+    ASSERT_EQ(actual, expected);
+
+    curve25519::ge_p1p1 sum;
+    curve25519::x25519_ge_add(&sum, &P, &Q_cached);
+    curve25519::x25519_ge_p1p1_to_p3(&R, &sum);
+    curve25519::ge_p3_tobytes(expected.data(), &R);
+    // in place as used by the receivers
+    R = P;
+    curve25519::x25519_ge_add_cmov(&R, &R, &Q_cached, 1);
+    curve25519::ge_p3_tobytes(actual.data(), &R);
+    ASSERT_EQ(actual, expected);
+}
@@ -0,0 +1,490 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <chrono>
+#include <future>
+#include <numeric>
+#include <thread>
+#include <boost/asio.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include "network/channel_multiplexer.hpp"
+#include "network/dummy_connection.hpp"
+#include "network/shaped_connection.hpp"
+#include "network/shared_memory_connection.hpp"
+#include "network/stats_connection.hpp"
+#include "network/tcp_connection.hpp"
+#include "ot/ot_hl17.hpp"
+#include "util/options.hpp"
+
+static bytes_t make_data(size_t n)
+{
+    bytes_t data(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 7 + i / 251);
+    }
+    return data;
+}
+
+TEST(SharedMemoryConnection_Test, AnyLength)
+{
+    // more data than fits into the ring
+    auto conn_pair = SharedMemoryConnection::make_pair(4096);
+    const auto data = make_data(100000);
+
+    auto fut_s{std::async(std::launch::async,
+        [&conn_pair, &data]
+        {
+            for (size_t offset = 0, length = 1; offset < data.size(); offset += length, length = length * 3 + 1)
+            {
+                length = std::min(length, data.size() - offset);
+                conn_pair.first->send(data.data() + offset, length);
+            }
+        })};
+    bytes_t received(data.size());
+    for (size_t offset = 0, length = 5000; offset < data.size(); offset += length)
+    {
+        length = std::min(length, data.size() - offset);
+        conn_pair.second->recv(received.data() + offset, length);
+    }
+    fut_s.get();
+    ASSERT_EQ(received, data);
+}
+
+TEST(SharedMemoryConnection_Test, Messages)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair(4096);
+    auto fut_s{std::async(std::launch::async,
+        [&conn_pair]
+        {
+            for (size_t length : {0, 1, 100, 10000})
+                conn_pair.second->send_message(make_data(length));
+        })};
+    for (size_t length : {0, 1, 100, 10000})
+    {
+        ASSERT_EQ(conn_pair.first->recv_message(), make_data(length));
+    }
+    fut_s.get();
+}
+
+TEST(SharedMemoryConnection_Test, AcrossProcesses)
+{
+    int fd = SharedMemoryConnection::create_region(4096);
+    const auto data = make_data(50000);
+    auto pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        // echo the data back
+        SharedMemoryConnection connection(fd, Role::client);
+        bytes_t buffer(data.size());
+        for (size_t offset = 0; offset < buffer.size(); offset += 1000)
+        {
+            connection.recv(buffer.data() + offset, 1000);
+            connection.send(buffer.data() + offset, 1000);
+        }
+        _exit(buffer == data ? 0 : 1);
+    }
+    SharedMemoryConnection connection(fd, Role::server);
+    close(fd);
+    bytes_t received(data.size());
+    auto fut_r{std::async(std::launch::async,
+        [&connection, &received]
+        {
+            connection.recv(received.data(), received.size());
+        })};
+    connection.send(data.data(), data.size());
+    fut_r.get();
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(WEXITSTATUS(status), 0);
+    ASSERT_EQ(received, data);
+}
+
+TEST(SharedMemoryConnection_Test, OT)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair();
+    OT_HL17 ot_sender{*conn_pair.first};
+    OT_HL17 ot_receiver{*conn_pair.second};
+
+    const size_t n = 100;
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+    auto fut_s{std::async(std::launch::async, [&ot_sender, n] { return ot_sender.send(n); })};
+    auto fut_r{std::async(std::launch::async, [&ot_receiver, &choices] { return ot_receiver.recv(choices); })};
+    auto out_s{fut_s.get()};
+    auto out_r{fut_r.get()};
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+    }
+}
+
+TEST(ChannelMultiplexer_Test, InterleavedChannels)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair(4096);
+    const size_t number_channels = 8;
+    const size_t n = 50;
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+
+    ChannelMultiplexer mux_s(*conn_pair.first);
+    ChannelMultiplexer mux_r(*conn_pair.second);
+    std::vector<std::future<std::vector<std::pair<bytes_t, bytes_t>>>> fut_s;
+    std::vector<std::future<std::vector<bytes_t>>> fut_r;
+    for (uint32_t c = 0; c < number_channels; ++c)
+    {
+        fut_s.push_back(std::async(std::launch::async, [&mux_s, c, n]
+            {
+                OT_HL17 ot(*mux_s.channel(c));
+                return ot.send(n);
+            }));
+        fut_r.push_back(std::async(std::launch::async, [&mux_r, c, &choices]
+            {
+                OT_HL17 ot(*mux_r.channel(c));
+                return ot.recv(choices);
+            }));
+    }
+    for (size_t c = 0; c < number_channels; ++c)
+    {
+        auto out_s = fut_s[c].get();
+        auto out_r = fut_r[c].get();
+        for (size_t i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+        }
+    }
+}
+
+TEST(ChannelMultiplexer_Test, LargeMessages)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair();
+    ChannelMultiplexer mux_a(*conn_pair.first);
+    ChannelMultiplexer mux_b(*conn_pair.second);
+    const auto data = make_data(3 * ChannelMultiplexer::max_frame_size + 5);
+    auto fut{std::async(std::launch::async, [&mux_a, &data]
+        {
+            mux_a.channel(1)->send_message(data);
+            mux_a.channel(2)->send(data.data(), 10);
+        })};
+    bytes_t small(10);
+    mux_b.channel(2)->recv(small.data(), small.size());
+    ASSERT_EQ(mux_b.channel(1)->recv_message(), data);
+    ASSERT_EQ(small, bytes_t(data.begin(), data.begin() + 10));
+    fut.get();
+}
+
+TEST(ChannelMultiplexer_Test, FlowControl)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair();
+    const size_t window_size = 4096;
+    ChannelMultiplexer mux_a(*conn_pair.first, window_size);
+    ChannelMultiplexer mux_b(*conn_pair.second, window_size);
+    const auto data = make_data(5 * window_size + 7);
+    auto fut{std::async(std::launch::async, [&mux_a, &data]
+        {
+            mux_a.channel(1)->send(data.data(), data.size());
+        })};
+    // channel 1 is not read, so the sender runs out of credit
+    ASSERT_EQ(fut.wait_for(std::chrono::milliseconds(100)), std::future_status::timeout);
+    // other channels are not affected
+    bytes_t small(10);
+    mux_a.channel(2)->send(data.data(), small.size());
+    mux_b.channel(2)->recv(small.data(), small.size());
+    ASSERT_EQ(small, bytes_t(data.begin(), data.begin() + 10));
+    bytes_t received(data.size());
+    mux_b.channel(1)->recv(received.data(), received.size());
+    fut.get();
+    ASSERT_EQ(received, data);
+}
+
+TEST(ChannelMultiplexer_Test, CreditAfterRecv)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair();
+    const size_t window_size = 4096;
+    ChannelMultiplexer mux_a(*conn_pair.first, window_size);
+    ChannelMultiplexer mux_b(*conn_pair.second, window_size);
+    const auto data = make_data(2 * window_size);
+    auto fut{std::async(std::launch::async, [&mux_a, &data]
+        {
+            mux_a.channel(1)->send(data.data(), window_size);
+            // needs the credit of the first recv
+            mux_a.channel(1)->send(data.data() + window_size, window_size);
+            mux_a.channel(2)->send(data.data(), 10);
+        })};
+    bytes_t received(data.size());
+    mux_b.channel(1)->recv(received.data(), window_size);
+    bytes_t small(10);
+    auto fut_small{std::async(std::launch::async, [&mux_b, &small]
+        {
+            mux_b.channel(2)->recv(small.data(), small.size());
+        })};
+    ASSERT_EQ(fut_small.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    ASSERT_EQ(small, bytes_t(data.begin(), data.begin() + 10));
+    mux_b.channel(1)->recv(received.data() + window_size, window_size);
+    fut.get();
+    ASSERT_EQ(received, data);
+}
+
+TEST(ChannelMultiplexer_Test, InvalidWindowSize)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair();
+    ASSERT_THROW(ChannelMultiplexer(*conn_pair.first, 0), std::invalid_argument);
+}
+
+static void test_vectored(Connection& sender, Connection& receiver)
+{
+    const auto data = make_data(20000);
+    auto fut{std::async(std::launch::async, [&sender, &data]
+        {
+            sender.send_v({{data.data(), 10}, {data.data() + 10, 0}, {data.data() + 10, 9990}});
+            sender.send_v({{data.data() + 10000, 5000}, {data.data() + 15000, 5000}});
+        })};
+    bytes_t received(data.size());
+    receiver.recv_v({{received.data(), 3}, {received.data() + 3, 12000}});
+    receiver.recv_v({{received.data() + 12003, 0}, {received.data() + 12003, 7997}});
+    fut.get();
+    ASSERT_EQ(received, data);
+}
+
+TEST(Connection_Test, VectoredDummy)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    test_vectored(*conn_pair.first, *conn_pair.second);
+}
+
+TEST(Connection_Test, VectoredSharedMemory)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair(4096);
+    test_vectored(*conn_pair.first, *conn_pair.second);
+}
+
+TEST(Connection_Test, VectoredTCP)
+{
+    using boost::asio::ip::tcp;
+    boost::asio::io_context io_context;
+    tcp::acceptor acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    tcp::socket client(io_context);
+    tcp::socket server(io_context);
+    client.connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+    TCPConnection conn_client(std::move(client));
+    TCPConnection conn_server(std::move(server));
+    test_vectored(conn_client, conn_server);
+}
+
+TEST(Connection_Test, SocketOptions)
+{
+    boost::asio::io_context io_context;
+    auto options = SocketOptions::low_latency();
+    options.send_buffer_size = 1 << 16;
+    options.receive_buffer_size = 1 << 16;
+    const uint16_t port = 7791;
+    auto fut{std::async(std::launch::async, [&io_context, &options]
+        {
+            return TCPConnection::listen(io_context, "127.0.0.1", port, options);
+        })};
+    Conn_p client;
+    // wait for the listener
+    for (size_t i = 0; i < 100 && !client; ++i)
+    {
+        try
+        {
+            client = TCPConnection::connect(io_context, "127.0.0.1", port, options);
+        }
+        catch (const boost::system::system_error&)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    ASSERT_TRUE(client);
+    auto server = fut.get();
+    test_vectored(*client, *server);
+
+    const auto data = make_data(32);
+    server->send_message(data);
+    ASSERT_EQ(client->recv_message(), data);
+}
+
+TEST(StatsConnection_Test, Counters)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats_a(*conn_pair.first);
+    StatsConnection stats_b(*conn_pair.second);
+    const auto data = make_data(100);
+    bytes_t buffer(100);
+
+    // two round trips from the perspective of a
+    stats_a.send(data.data(), 10);
+    stats_a.send_message(data);
+    stats_b.recv(buffer.data(), 10);
+    ASSERT_EQ(stats_b.recv_message(), data);
+    stats_b.send_v({{data.data(), 20}, {data.data(), 30}});
+    stats_a.async_recv(buffer.data(), 50).get();
+    stats_a.send(data.data(), 1);
+    stats_b.recv(buffer.data(), 1);
+    stats_b.send(data.data(), 2);
+    stats_a.recv(buffer.data(), 2);
+
+    auto a = stats_a.snapshot();
+    ASSERT_EQ(a.bytes_sent, 111);
+    ASSERT_EQ(a.messages_sent, 3);
+    ASSERT_EQ(a.bytes_received, 52);
+    ASSERT_EQ(a.messages_received, 2);
+    ASSERT_EQ(a.round_trips, 2);
+    ASSERT_EQ(std::accumulate(a.recv_blocked_histogram.begin(), a.recv_blocked_histogram.end(), uint64_t(0)), 2);
+
+    auto b = stats_b.snapshot();
+    ASSERT_EQ(b.bytes_sent, 52);
+    ASSERT_EQ(b.bytes_received, 111);
+    ASSERT_EQ(b.round_trips, 1);
+
+    stats_a.reset();
+    ASSERT_EQ(stats_a.snapshot().bytes_sent, 0);
+}
+
+TEST(StatsConnection_Test, BlockingAsyncRecv)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats(*conn_pair.first);
+    const auto data = make_data(10);
+    bytes_t buffer(10);
+
+    auto fut{std::async(std::launch::async, [&conn_pair, &data]
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            conn_pair.second->send(data.data(), data.size());
+        })};
+    // DummyConnection receives in async_recv itself
+    stats.async_recv(buffer.data(), buffer.size()).get();
+    fut.get();
+    ASSERT_EQ(buffer, data);
+
+    auto snapshot = stats.snapshot();
+    ASSERT_GE(snapshot.recv_blocked, std::chrono::milliseconds(10));
+    // 2^14 us < 20 ms < 2^15 us
+    ASSERT_EQ(std::accumulate(snapshot.recv_blocked_histogram.begin() + 14, snapshot.recv_blocked_histogram.end(), uint64_t(0)), 1);
+}
+
+TEST(ShapedConnection_Test, Pacing)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair(4096);
+    NetworkProfile profile;
+    profile.bandwidth = 8e7;
+    profile.jitter = std::chrono::microseconds(100);
+    profile.packet_size = 1000;
+    profile.buffer_size = 5000;
+    ShapedConnection shaped(*conn_pair.first, profile);
+    const auto data = make_data(100000);
+
+    // 800 kbit at 80 Mbit/s
+    auto start = std::chrono::steady_clock::now();
+    auto fut{std::async(std::launch::async, [&shaped, &data]
+        {
+            shaped.send(data.data(), 50000);
+            shaped.send_v({{data.data() + 50000, 1}, {data.data() + 50001, 49999}});
+            shaped.send_message(data);
+        })};
+    bytes_t received(data.size());
+    conn_pair.second->recv(received.data(), received.size());
+    ASSERT_EQ(received, data);
+    ASSERT_EQ(conn_pair.second->recv_message(), data);
+    fut.get();
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+}
+
+TEST(ShapedConnection_Test, RoundTripTime)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    NetworkProfile profile;
+    profile.rtt = std::chrono::milliseconds(20);
+    ShapedConnection shaped_a(*conn_pair.first, profile);
+    ShapedConnection shaped_b(*conn_pair.second, profile);
+    const auto data = make_data(10);
+    bytes_t buffer(10);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < 3; ++i)
+    {
+        shaped_a.send(data.data(), data.size());
+        shaped_b.recv(buffer.data(), buffer.size());
+        shaped_b.send(buffer.data(), buffer.size());
+        shaped_a.recv(buffer.data(), buffer.size());
+    }
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(60));
+    ASSERT_EQ(buffer, data);
+}
+
+TEST(ShapedConnection_Test, Flush)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats(*conn_pair.first);
+    NetworkProfile profile;
+    profile.rtt = std::chrono::milliseconds(40);
+    profile.packet_size = 1000;
+    ShapedConnection shaped(stats, profile);
+    const auto data = make_data(10000);
+
+    auto start = std::chrono::steady_clock::now();
+    shaped.send(data.data(), data.size());
+    shaped.flush();
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    // everything is handed to the underlying connection
+    ASSERT_EQ(stats.snapshot().bytes_sent, data.size());
+    bytes_t received(data.size());
+    start = std::chrono::steady_clock::now();
+    conn_pair.second->recv(received.data(), received.size());
+    ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(10));
+    ASSERT_EQ(received, data);
+}
+
+TEST(ShapedConnection_Test, OT)
+{
+    auto conn_pair = SharedMemoryConnection::make_pair(1 << 16);
+    ShapedConnection shaped_s(*conn_pair.first, NetworkProfile::lan());
+    ShapedConnection shaped_r(*conn_pair.second, NetworkProfile::lan());
+    OT_HL17 ot_s(shaped_s);
+    OT_HL17 ot_r(shaped_r);
+    const size_t number_ots = 100;
+    std::vector<bool> choices(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+    auto fut{std::async(std::launch::async, [&ot_s, number_ots] { return ot_s.send(number_ots); })};
+    auto output_r = ot_r.recv(choices);
+    auto output_s = fut.get();
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        ASSERT_EQ(output_r[i], choices[i] ? output_s[i].second : output_s[i].first);
+    }
+}
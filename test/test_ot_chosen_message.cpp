@@ -0,0 +1,91 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <gtest/gtest.h>
+#include "network/dummy_connection.hpp"
+#include "ot/ot_chosen_message.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+
+
+TEST(ChosenMessageOT_Test, Single)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 random_ot_sender{*conn_pair.first};
+    OT_HL17 random_ot_receiver{*conn_pair.second};
+    ChosenMessageOT ot_sender{*conn_pair.first, random_ot_sender};
+    ChosenMessageOT ot_receiver{*conn_pair.second, random_ot_receiver};
+    const std::vector<bytes_t> messages{random_bytes(100), random_bytes(100)};
+
+    for (size_t choice : {0, 1})
+    {
+        auto fut_s{std::async(std::launch::async, [&ot_sender, &messages] { ot_sender.send(messages); })};
+        auto output{ot_receiver.recv(choice)};
+        fut_s.get();
+        ASSERT_EQ(output, messages[choice]);
+    }
+    ASSERT_THROW(ot_sender.send({random_bytes(1)}), std::invalid_argument);
+}
+
+static void test_chosen_message_batch(size_t message_size, size_t number_ots)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot_sender{*conn_pair.first};
+    OT_HL17 base_ot_receiver{*conn_pair.second};
+    OTExtension random_ot_sender{*conn_pair.first, base_ot_sender};
+    OTExtension random_ot_receiver{*conn_pair.second, base_ot_receiver};
+    ChosenMessageOT ot_sender{*conn_pair.first, random_ot_sender};
+    ChosenMessageOT ot_receiver{*conn_pair.second, random_ot_receiver};
+
+    const auto messages = random_bytes(2 * number_ots * message_size);
+    const auto choice_bytes = random_bytes(number_ots);
+    std::vector<bool> choices(number_ots);
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        choices[i] = choice_bytes[i] & 1;
+    }
+
+    auto fut_s{std::async(std::launch::async, [&ot_sender, &messages, message_size, number_ots]
+        {
+            ot_sender.send(messages.data(), message_size, number_ots);
+        })};
+    bytes_t output(number_ots * message_size);
+    ot_receiver.recv(output.data(), message_size, choices);
+    fut_s.get();
+
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        const auto expected = messages.data() + (2 * i + choices[i]) * message_size;
+        ASSERT_TRUE(std::equal(expected, expected + message_size, output.data() + i * message_size));
+    }
+}
+
+TEST(ChosenMessageOT_Test, BatchShortMessages)
+{
+    test_chosen_message_batch(8, 10000);
+}
+
+TEST(ChosenMessageOT_Test, BatchLongMessages)
+{
+    test_chosen_message_batch(ChosenMessageOT::chunk_size + 3, 5);
+}
@@ -26,6 +26,16 @@
 #include "network/dummy_connection.hpp"
 #include "ot/ot_co15.hpp"
 
+static bytes_t to_bytes(const ot_key_t& key)
+{
+    return bytes_t(key.cbegin(), key.cend());
+}
+
+static std::pair<bytes_t, bytes_t> to_bytes(const ot_key_t& key_0, const ot_key_t& key_1)
+{
+    return {to_bytes(key_0), to_bytes(key_1)};
+}
+
 TEST(OT_CO15_Test, SR0)
 {
     DevNullConnection connection;
@@ -78,6 +88,42 @@ TEST(OT_CO15_Test, SR1)
 }
 
 
+TEST(OT_CO15_Test, SRBatch)
+{
+    DevNullConnection connection;
+    OT_CO15 ot{connection};
+
+    const size_t n = 10;
+    OT_CO15::Sender_SharedState sss;
+    std::vector<OT_CO15::Receiver_State> rs(n);
+    OT_CO15::Receiver_SharedState rss;
+
+    std::array<uint8_t, OT_CO15::curve25519_ge_byte_size> msg_s0;
+    std::vector<std::array<uint8_t, OT_CO15::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<ot_key_t> res_s(2 * n);
+    std::vector<ot_key_t> res_r(n);
+
+    ot.send_0(sss, msg_s0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1(rss, msg_s0);
+    ot.recv_2_batch(rs.data(), rss, msgs_r1.data(), n);
+
+    ot.send_1_batch(sss, res_s.data(), msg_s0, msgs_r1.data(), n);
+    ot.recv_3_batch(rs.data(), rss, res_r.data(), msg_s0, msgs_r1.data(), n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(res_r[i], res_s[2 * i + i % 2]);
+        // the single versions agree with the batch versions
+        ASSERT_EQ(ot.send_1(sss, msgs_r1[i]), to_bytes(res_s[2 * i], res_s[2 * i + 1]));
+        ASSERT_EQ(ot.recv_3(rs[i], rss), to_bytes(res_r[i]));
+    }
+}
+
+
 TEST(OT_CO15_Test, SRConnection0)
 {
     auto conn_pair = DummyConnection::make_dummies();
@@ -127,3 +173,38 @@ TEST(OT_CO15_Test, SRConnection1)
 
     ASSERT_EQ(out_r, out_s.second);
 }
+
+TEST(OT_CO15_Test, SRConnectionInto)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_CO15 ot_sender{*conn_pair.first};
+    OT_CO15 ot_receiver{*conn_pair.second};
+
+    const size_t n = 100;
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+    std::vector<ot_key_t> out_s(2 * n);
+    std::vector<ot_key_t> out_r(n);
+
+    auto fut_s{std::async(std::launch::async,
+        [&ot_sender, &out_s, n]
+        {
+            ot_sender.send_into(out_s.data(), n);
+        })};
+    auto fut_r{std::async(std::launch::async,
+        [&ot_receiver, &out_r, &choices]
+        {
+            ot_receiver.recv_into(out_r.data(), choices);
+        })};
+    fut_s.get();
+    fut_r.get();
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_NE(out_s[2 * i], out_s[2 * i + 1]);
+        ASSERT_EQ(out_r[i], out_s[2 * i + choices[i]]);
+    }
+}
@@ -0,0 +1,74 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <boost/asio/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include "network/dummy_connection.hpp"
+#include "ot/ot_correlated.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+
+
+TEST(CorrelatedOT_Test, GlobalDelta)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot_sender{*conn_pair.first};
+    OT_HL17 base_ot_receiver{*conn_pair.second};
+    OTExtension random_ot_sender{*conn_pair.first, base_ot_sender};
+    OTExtension random_ot_receiver{*conn_pair.second, base_ot_receiver};
+    CorrelatedOT ot_sender{*conn_pair.first, random_ot_sender};
+    CorrelatedOT ot_receiver{*conn_pair.second, random_ot_receiver};
+    const auto delta = ot_sender.delta();
+
+    for (size_t number_ots : {10000, 1})
+    {
+        std::vector<bool> choices(number_ots);
+        const auto choice_bytes = random_bytes(number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            choices[i] = choice_bytes[i] & 1;
+        }
+
+        std::vector<ot_key_t> out_s(number_ots);
+        std::vector<ot_key_t> out_r(number_ots);
+        auto fut_s{std::async(std::launch::async, [&ot_sender, &out_s, number_ots]
+            {
+                ot_sender.send(out_s.data(), number_ots);
+            })};
+        ot_receiver.recv(out_r.data(), choices, 2);
+        fut_s.get();
+
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            auto expected = out_s[i];
+            if (choices[i])
+            {
+                for (size_t k = 0; k < expected.size(); ++k)
+                {
+                    expected[k] ^= delta[k];
+                }
+            }
+            ASSERT_EQ(out_r[i], expected);
+        }
+    }
+}
@@ -0,0 +1,252 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <boost/asio/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include "network/dummy_connection.hpp"
+#include "ot/ot_co15.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+#include "util/bit_matrix.hpp"
+#include "util/gf128.hpp"
+
+TEST(BitMatrix_Test, Transpose)
+{
+    const size_t rows = 128;
+    const size_t cols = 192;
+    auto input = random_bytes(rows * cols / 8);
+    bytes_t transposed(input.size());
+    bytes_t output(input.size());
+
+    transpose_bit_matrix(transposed.data(), input.data(), rows, cols);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        for (size_t j = 0; j < cols; ++j)
+        {
+            bool in_bit = (input[i * cols / 8 + j / 8] >> (j % 8)) & 1;
+            bool out_bit = (transposed[j * rows / 8 + i / 8] >> (i % 8)) & 1;
+            ASSERT_EQ(in_bit, out_bit);
+        }
+    }
+
+    transpose_bit_matrix(output.data(), transposed.data(), cols, rows);
+    ASSERT_EQ(input, output);
+}
+
+
+TEST(GF128_Test, Multiplication)
+{
+    const auto default_impl = gf128_get_impl();
+    const size_t n = 100;
+    auto a = random_bytes(16 * n);
+    auto b = random_bytes(16 * n);
+    auto c = random_bytes(16);
+
+    // X^127 * X = X^7 + X^2 + X + 1
+    std::array<uint8_t, 16> x_127{}, x{}, product, expected{};
+    x_127[15] = 0x80;
+    x[0] = 0x02;
+    expected[0] = 0x87;
+
+    std::vector<std::array<uint8_t, 16>> results;
+    for (auto impl : {GF128Impl::portable, GF128Impl::pclmul})
+    {
+        if (!gf128_set_impl(impl))
+            continue;
+        gf128_mul(product.data(), x_127.data(), x.data());
+        ASSERT_EQ(product, expected);
+
+        // (a_i * b_i) * c = a_i * (b_i * c)
+        std::array<uint8_t, 16> ab, bc, left, right;
+        for (size_t i = 0; i < n; ++i)
+        {
+            gf128_mul(ab.data(), a.data() + 16 * i, b.data() + 16 * i);
+            gf128_mul(left.data(), ab.data(), c.data());
+            gf128_mul(bc.data(), b.data() + 16 * i, c.data());
+            gf128_mul(right.data(), a.data() + 16 * i, bc.data());
+            ASSERT_EQ(left, right);
+        }
+
+        gf128_sum_t sum{};
+        gf128_mul_add(sum, a.data(), b.data(), n);
+        gf128_reduce(product.data(), sum);
+        results.push_back(product);
+    }
+    gf128_set_impl(default_impl);
+    for (const auto& result : results)
+    {
+        ASSERT_EQ(result, results.front());
+    }
+}
+
+
+template <typename BaseOT>
+void test_ot_extension(const std::vector<size_t>& batch_sizes, size_t number_threads, bool active_security=false)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    BaseOT base_ot_sender{*conn_pair.first};
+    BaseOT base_ot_receiver{*conn_pair.second};
+    OTExtension ot_sender{*conn_pair.first, base_ot_sender, active_security};
+    OTExtension ot_receiver{*conn_pair.second, base_ot_receiver, active_security};
+    boost::asio::thread_pool thread_pool_sender(number_threads);
+    boost::asio::thread_pool thread_pool_receiver(number_threads);
+
+    for (auto number_ots : batch_sizes)
+    {
+        std::vector<bool> choices(number_ots);
+        auto choice_bytes = random_bytes(number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            choices[i] = choice_bytes[i] & 1;
+        }
+
+        auto fut_s{std::async(std::launch::async,
+            [&ot_sender, &thread_pool_sender, number_ots, number_threads]
+            {
+                if (number_threads == 1)
+                    return ot_sender.send(number_ots);
+                return ot_sender.parallel_send(number_ots, number_threads, thread_pool_sender);
+            })};
+        auto fut_r{std::async(std::launch::async,
+            [&ot_receiver, &thread_pool_receiver, &choices, number_threads]
+            {
+                if (number_threads == 1)
+                    return ot_receiver.recv(choices);
+                return ot_receiver.parallel_recv(choices, number_threads, thread_pool_receiver);
+            })};
+        auto out_s{fut_s.get()};
+        auto out_r{fut_r.get()};
+
+        ASSERT_EQ(out_s.size(), number_ots);
+        ASSERT_EQ(out_r.size(), number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            ASSERT_EQ(out_r[i].size(), OTExtension::key_size);
+            ASSERT_NE(out_s[i].first, out_s[i].second);
+            ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+        }
+    }
+
+    thread_pool_sender.join();
+    thread_pool_receiver.join();
+}
+
+TEST(OTExtension_Test, HL17Batch)
+{
+    test_ot_extension<OT_HL17>({1000, 1, 64, 4097}, 1);
+}
+
+TEST(OTExtension_Test, CO15Batch)
+{
+    test_ot_extension<OT_CO15>({1000, 1, 64, 4097}, 1);
+}
+
+TEST(OTExtension_Test, HL17Parallel)
+{
+    test_ot_extension<OT_HL17>({1000, 1, 64, 4097}, 4);
+}
+
+TEST(OTExtension_Test, KOS15Batch)
+{
+    test_ot_extension<OT_HL17>({1000, 1, 64, 4097}, 1, true);
+}
+
+TEST(OTExtension_Test, KOS15Parallel)
+{
+    test_ot_extension<OT_CO15>({1000, 1, 64, 4097}, 4, true);
+}
+
+// Flips a bit in every message of the given size once armed.
+class TamperingConnection : public Connection
+{
+public:
+    TamperingConnection(Connection& connection, size_t size)
+        : connection_(connection), size_(size), armed_(false) {}
+    void arm() { armed_ = true; }
+    void send_message(const uint8_t* buffer, size_t length) override { connection_.send_message(buffer, length); }
+    bytes_t recv_message() override { return connection_.recv_message(); }
+    void send(const uint8_t* buffer, size_t length) override
+    {
+        if (!armed_ || length != size_)
+            return connection_.send(buffer, length);
+        bytes_t tampered(buffer, buffer + length);
+        tampered.back() ^= 1;
+        connection_.send(tampered.data(), tampered.size());
+    }
+    void recv(uint8_t* buffer, size_t length) override { connection_.recv(buffer, length); }
+    using Connection::send_message;
+private:
+    Connection& connection_;
+    size_t size_;
+    bool armed_;
+};
+
+TEST(OTExtension_Test, KOS15CheckFails)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    // the receiver's response to the check has 32 bytes
+    TamperingConnection tampering{*conn_pair.second, 2 * OTExtension::key_size};
+    OT_HL17 base_ot_sender{*conn_pair.first};
+    OT_HL17 base_ot_receiver{tampering};
+    OTExtension ot_sender{*conn_pair.first, base_ot_sender, true};
+    OTExtension ot_receiver{tampering, base_ot_receiver, true};
+    const std::vector<bool> choices(100, true);
+
+    // the base OTs also send 32 byte messages
+    auto fut_s{std::async(std::launch::async, [&ot_sender] { return ot_sender.send(100); })};
+    ot_receiver.recv(choices);
+    fut_s.get();
+
+    tampering.arm();
+    fut_s = std::async(std::launch::async, [&ot_sender] { return ot_sender.send(100); });
+    ot_receiver.recv(choices);
+    ASSERT_THROW(fut_s.get(), std::runtime_error);
+}
+
+TEST(OTExtension_Test, SRConnection)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_CO15 base_ot_sender{*conn_pair.first};
+    OT_CO15 base_ot_receiver{*conn_pair.second};
+    OTExtension ot_sender{*conn_pair.first, base_ot_sender};
+    OTExtension ot_receiver{*conn_pair.second, base_ot_receiver};
+
+    for (bool choice : {false, true})
+    {
+        auto fut_s_1{std::async(std::launch::async,
+            [&ot_sender]
+            {
+                return ot_sender.send();
+            })};
+
+        auto fut_r_1{std::async(std::launch::async,
+            [&ot_receiver, choice]
+            {
+                return ot_receiver.recv(choice);
+            })};
+        auto out_s{fut_s_1.get()};
+        auto out_r{fut_r_1.get()};
+
+        ASSERT_EQ(out_r, choice ? out_s.second : out_s.first);
+    }
+}
@@ -20,12 +20,26 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <algorithm>
+#include <atomic>
 #include <future>
+#include <boost/asio.hpp>
 #include <gtest/gtest.h>
 #include "network/devnull_connection.hpp"
 #include "network/dummy_connection.hpp"
+#include "network/tcp_connection.hpp"
 #include "ot/ot_hl17.hpp"
 
+static bytes_t to_bytes(const ot_key_t& key)
+{
+    return bytes_t(key.cbegin(), key.cend());
+}
+
+static std::pair<bytes_t, bytes_t> to_bytes(const ot_key_t& key_0, const ot_key_t& key_1)
+{
+    return {to_bytes(key_0), to_bytes(key_1)};
+}
+
 TEST(OT_HL17_Test, SR0)
 {
     DevNullConnection connection;
@@ -76,6 +90,85 @@ TEST(OT_HL17_Test, SR1)
 }
 
 
+TEST(OT_HL17_Test, SRBatch)
+{
+    DevNullConnection connection;
+    OT_HL17 ot{connection};
+
+    const size_t n = 10;
+    std::vector<OT_HL17::Sender_State> ss(n);
+    std::vector<OT_HL17::Receiver_State> rs(n);
+
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_s0(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> S_bytes(n);
+    std::vector<ot_key_t> res_s(2 * n);
+    std::vector<ot_key_t> res_r(n);
+
+    ot.send_0_batch(ss.data(), msgs_s0.data(), n);
+    ot.send_1_batch(ss.data(), msgs_s0.data(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1_batch(rs.data(), msgs_r1.data(), S_bytes.data(), msgs_s0.data(), n);
+    ASSERT_EQ(S_bytes, msgs_s0);
+
+    ot.send_2_batch(ss.data(), res_s.data(), msgs_s0.data(), msgs_r1.data(), n);
+    ot.recv_2_batch(rs.data(), res_r.data(), S_bytes.data(), msgs_r1.data(), n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(res_r[i], res_s[2 * i + i % 2]);
+        // the single versions agree with the batch versions
+        ASSERT_EQ(ot.send_2(ss[i], msgs_r1[i]), to_bytes(res_s[2 * i], res_s[2 * i + 1]));
+        ASSERT_EQ(ot.recv_2(rs[i]), to_bytes(res_r[i]));
+    }
+}
+
+
+TEST(OT_HL17_Test, SRSharedBatch)
+{
+    DevNullConnection connection;
+    OT_HL17 ot{connection, true};
+
+    const size_t n = 10;
+    OT_HL17::Sender_SharedState sss;
+    OT_HL17::Receiver_SharedState rss;
+    std::vector<OT_HL17::Receiver_State> rs(n);
+
+    std::array<uint8_t, OT_HL17::curve25519_ge_byte_size> msg_s0;
+    std::array<uint8_t, OT_HL17::curve25519_ge_byte_size> S_bytes;
+    std::vector<std::array<uint8_t, OT_HL17::curve25519_ge_byte_size>> msgs_r1(n);
+    std::vector<ot_key_t> res_s(2 * n);
+    std::vector<ot_key_t> res_r(n);
+
+    ot.send_0(sss, msg_s0);
+    ot.send_1(sss, msg_s0);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ot.recv_0(rs[i], i % 2);
+    }
+    ot.recv_1(rss, S_bytes, msg_s0);
+    ASSERT_EQ(S_bytes, msg_s0);
+    ot.recv_1_batch(rs.data(), rss, msgs_r1.data(), n);
+
+    ot.send_2_batch(sss, res_s.data(), msg_s0, msgs_r1.data(), n);
+    ot.recv_2_batch(rs.data(), rss, res_r.data(), S_bytes, msgs_r1.data(), n);
+
+    // y*R - y*T agrees with y*(R - T)
+    OT_HL17::Sender_State ss;
+    std::copy(std::begin(sss.y), std::end(sss.y), ss.y);
+    ss.S = sss.S;
+    ss.T = sss.T;
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(res_r[i], res_s[2 * i + i % 2]);
+        ASSERT_EQ(ot.send_2(ss, msgs_r1[i]), to_bytes(res_s[2 * i], res_s[2 * i + 1]));
+    }
+}
+
+
 TEST(OT_HL17_Test, SRConnection0)
 {
     auto conn_pair = DummyConnection::make_dummies();
@@ -125,3 +218,154 @@ TEST(OT_HL17_Test, SRConnection1)
 
     ASSERT_EQ(out_r, out_s.second);
 }
+
+TEST(OT_HL17_Test, SRSharedConnection)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 ot_sender{*conn_pair.first, true};
+    OT_HL17 ot_receiver{*conn_pair.second, true};
+
+    const size_t n = 10;
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+
+    auto fut_s{std::async(std::launch::async,
+        [&ot_sender, n]
+        {
+            return ot_sender.parallel_send(n, 2);
+        })};
+    auto fut_r{std::async(std::launch::async,
+        [&ot_receiver, &choices]
+        {
+            return ot_receiver.parallel_recv(choices, 2);
+        })};
+    auto out_s{fut_s.get()};
+    auto out_r{fut_r.get()};
+
+    ASSERT_EQ(out_s.size(), n);
+    ASSERT_EQ(out_r.size(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+    }
+}
+
+static void test_pipelined(bool shared_state, size_t number_threads)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 ot_sender{*conn_pair.first, shared_state};
+    OT_HL17 ot_receiver{*conn_pair.second, shared_state};
+    ot_sender.set_chunk_size(32);
+    ot_receiver.set_chunk_size(32);
+
+    const size_t n = 100;
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+
+    auto fut_s{std::async(std::launch::async,
+        [&ot_sender, n, number_threads]
+        {
+            if (number_threads == 1)
+                return ot_sender.send(n);
+            return ot_sender.parallel_send(n, number_threads);
+        })};
+    auto fut_r{std::async(std::launch::async,
+        [&ot_receiver, &choices, number_threads]
+        {
+            if (number_threads == 1)
+                return ot_receiver.recv(choices);
+            return ot_receiver.parallel_recv(choices, number_threads);
+        })};
+    auto out_s{fut_s.get()};
+    auto out_r{fut_r.get()};
+
+    ASSERT_EQ(out_s.size(), n);
+    ASSERT_EQ(out_r.size(), n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_NE(out_s[i].first, out_s[i].second);
+        ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+    }
+}
+
+TEST(OT_HL17_Test, SRPipelined)
+{
+    test_pipelined(false, 1);
+    test_pipelined(true, 1);
+}
+
+TEST(OT_HL17_Test, SRPipelinedParallel)
+{
+    test_pipelined(false, 3);
+    test_pipelined(true, 3);
+}
+
+TEST(OT_HL17_Test, AsyncSessionsShareIOThread)
+{
+    using boost::asio::ip::tcp;
+    const size_t number_sessions = 4;
+    const size_t n = 50;
+    boost::asio::io_context io_context;
+
+    std::vector<std::unique_ptr<TCPConnection>> connections;
+    tcp::acceptor acceptor(io_context, tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0));
+    for (size_t s = 0; s < number_sessions; ++s)
+    {
+        tcp::socket client(io_context);
+        tcp::socket server(io_context);
+        client.connect(acceptor.local_endpoint());
+        acceptor.accept(server);
+        connections.push_back(std::make_unique<TCPConnection>(std::move(server)));
+        connections.push_back(std::make_unique<TCPConnection>(std::move(client)));
+    }
+
+    std::vector<bool> choices(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        choices[i] = i % 3 == 0;
+    }
+    std::vector<std::unique_ptr<OT_HL17>> ots;
+    std::vector<std::vector<ot_key_t>> outputs;
+    std::atomic<size_t> completed(0);
+    for (size_t s = 0; s < number_sessions; ++s)
+    {
+        ots.push_back(std::make_unique<OT_HL17>(*connections[2 * s]));
+        ots.push_back(std::make_unique<OT_HL17>(*connections[2 * s + 1]));
+        outputs.emplace_back(2 * n);
+        outputs.emplace_back(n);
+    }
+    // the computation runs in the global thread pool, so keep the io_context
+    // running until all sessions are done
+    auto work_guard = boost::asio::make_work_guard(io_context);
+    auto done = [&completed, &io_context, &work_guard, number_sessions](std::error_code error)
+    {
+        EXPECT_FALSE(error);
+        if (++completed == 2 * number_sessions)
+            boost::asio::post(io_context, [&work_guard] { work_guard.reset(); });
+    };
+    for (size_t s = 0; s < number_sessions; ++s)
+    {
+        ots[2 * s]->async_send_into(outputs[2 * s].data(), n, done);
+        ots[2 * s + 1]->async_recv_into(outputs[2 * s + 1].data(), choices, done);
+    }
+    // all sessions are driven by this thread
+    io_context.run();
+
+    ASSERT_EQ(completed, 2 * number_sessions);
+    for (size_t s = 0; s < number_sessions; ++s)
+    {
+        const auto& out_s = outputs[2 * s];
+        const auto& out_r = outputs[2 * s + 1];
+        for (size_t i = 0; i < n; ++i)
+        {
+            ASSERT_NE(out_s[2 * i], out_s[2 * i + 1]);
+            ASSERT_EQ(out_r[i], out_s[2 * i + choices[i]]);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <set>
+#include <boost/asio/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include "network/dummy_connection.hpp"
+#include "ot/ot_hl17.hpp"
+#include "ot/ot_kk13.hpp"
+
+
+static void check_kk13(size_t number_messages, size_t number_threads)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot_sender{*conn_pair.first};
+    OT_HL17 base_ot_receiver{*conn_pair.second};
+    OT_KK13 ot_sender{*conn_pair.first, base_ot_sender, number_messages};
+    OT_KK13 ot_receiver{*conn_pair.second, base_ot_receiver, number_messages};
+    ASSERT_EQ(ot_sender.number_messages(), number_messages);
+
+    // the second batch reuses the base OTs
+    for (size_t number_ots : {1000, 1})
+    {
+        std::vector<size_t> choices(number_ots);
+        const auto choice_bytes = random_bytes(number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            choices[i] = choice_bytes[i] % number_messages;
+        }
+
+        std::vector<ot_key_t> out_s(number_messages * number_ots);
+        std::vector<ot_key_t> out_r(number_ots);
+        auto fut_s{std::async(std::launch::async, [&ot_sender, &out_s, number_ots, number_threads]
+            {
+                if (number_threads == 1)
+                    ot_sender.send_into(out_s.data(), number_ots);
+                else
+                    ot_sender.parallel_send_into(out_s.data(), number_ots, number_threads);
+            })};
+        if (number_threads == 1)
+            ot_receiver.recv_into(out_r.data(), choices);
+        else
+            ot_receiver.parallel_recv_into(out_r.data(), choices, number_threads);
+        fut_s.get();
+
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            std::set<ot_key_t> keys(out_s.cbegin() + number_messages * i,
+                                    out_s.cbegin() + number_messages * (i + 1));
+            ASSERT_EQ(keys.size(), number_messages);
+            ASSERT_EQ(out_r[i], out_s[number_messages * i + choices[i]]);
+        }
+    }
+}
+
+TEST(OT_KK13_Test, Batch)
+{
+    for (size_t number_messages : {2, 16, 256})
+    {
+        check_kk13(number_messages, 1);
+    }
+}
+
+TEST(OT_KK13_Test, Parallel)
+{
+    check_kk13(16, 4);
+}
+
+TEST(OT_KK13_Test, InvalidArguments)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot{*conn_pair.second};
+    ASSERT_THROW(OT_KK13(*conn_pair.second, base_ot, 1), std::invalid_argument);
+    ASSERT_THROW(OT_KK13(*conn_pair.second, base_ot, 257), std::invalid_argument);
+    OT_KK13 ot_receiver{*conn_pair.second, base_ot, 4};
+    ot_key_t output;
+    ASSERT_THROW(ot_receiver.recv_into(&output, {4}), std::invalid_argument);
+}
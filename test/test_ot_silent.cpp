@@ -0,0 +1,137 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <future>
+#include <boost/asio/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include "network/dummy_connection.hpp"
+#include "network/stats_connection.hpp"
+#include "ot/ot_extension.hpp"
+#include "ot/ot_hl17.hpp"
+#include "ot/ot_silent.hpp"
+
+
+// Silent OT with base OTs from an OT extension on top of HL17.
+struct SilentOTParty
+{
+    SilentOTParty(Connection& connection)
+        : hl17(connection), extension(connection, hl17), silent_ot(connection, extension) {}
+    OT_HL17 hl17;
+    OTExtension extension;
+    SilentOT silent_ot;
+};
+
+static void test_silent_ot(const std::vector<size_t>& batch_sizes, size_t number_threads)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    SilentOTParty sender{*conn_pair.first};
+    SilentOTParty receiver{*conn_pair.second};
+    boost::asio::thread_pool thread_pool_sender(number_threads);
+    boost::asio::thread_pool thread_pool_receiver(number_threads);
+
+    for (auto number_ots : batch_sizes)
+    {
+        std::vector<bool> choices(number_ots);
+        auto choice_bytes = random_bytes(number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            choices[i] = choice_bytes[i] & 1;
+        }
+
+        auto fut_s{std::async(std::launch::async,
+            [&sender, &thread_pool_sender, number_ots, number_threads]
+            {
+                return sender.silent_ot.parallel_send(number_ots, number_threads, thread_pool_sender);
+            })};
+        auto out_r{receiver.silent_ot.parallel_recv(choices, number_threads, thread_pool_receiver)};
+        auto out_s{fut_s.get()};
+
+        ASSERT_EQ(out_s.size(), number_ots);
+        ASSERT_EQ(out_r.size(), number_ots);
+        for (size_t i = 0; i < number_ots; ++i)
+        {
+            ASSERT_NE(out_s[i].first, out_s[i].second);
+            ASSERT_EQ(out_r[i], choices[i] ? out_s[i].second : out_s[i].first);
+        }
+    }
+
+    thread_pool_sender.join();
+    thread_pool_receiver.join();
+}
+
+TEST(SilentOT_Test, Batch)
+{
+    test_silent_ot({1000, 1, 4097}, 1);
+}
+
+TEST(SilentOT_Test, Parallel)
+{
+    test_silent_ot({1000, 100000}, 4);
+}
+
+TEST(SilentOT_Test, HL17BaseOTs)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    OT_HL17 base_ot_sender{*conn_pair.first};
+    OT_HL17 base_ot_receiver{*conn_pair.second};
+    SilentOT ot_sender{*conn_pair.first, base_ot_sender};
+    SilentOT ot_receiver{*conn_pair.second, base_ot_receiver};
+
+    for (bool choice : {false, true})
+    {
+        auto fut_s{std::async(std::launch::async, [&ot_sender] { return ot_sender.send(); })};
+        auto out_r{ot_receiver.recv(choice)};
+        auto out_s{fut_s.get()};
+        ASSERT_EQ(out_r, choice ? out_s.second : out_s.first);
+    }
+}
+
+TEST(SilentOT_Test, RandomChoicesSublinear)
+{
+    auto conn_pair = DummyConnection::make_dummies();
+    StatsConnection stats_sender{*conn_pair.first};
+    StatsConnection stats_receiver{*conn_pair.second};
+    SilentOTParty sender{stats_sender};
+    SilentOTParty receiver{stats_receiver};
+    const size_t number_ots = 1 << 18;
+
+    std::vector<ot_key_t> out_s(2 * number_ots);
+    std::vector<ot_key_t> out_r(number_ots);
+    auto fut_s{std::async(std::launch::async,
+        [&sender, &out_s, number_ots] { sender.silent_ot.send_random_into(out_s.data(), number_ots); })};
+    auto choices{receiver.silent_ot.recv_random_into(out_r.data(), number_ots)};
+    fut_s.get();
+
+    ASSERT_EQ(choices.size(), number_ots);
+    size_t ones = 0;
+    for (size_t i = 0; i < number_ots; ++i)
+    {
+        ASSERT_EQ(out_r[i], out_s[2 * i + choices[i]]);
+        ones += choices[i];
+    }
+    ASSERT_GT(ones, number_ots / 4);
+    ASSERT_LT(ones, 3 * number_ots / 4);
+
+    // IKNP03 would send 16 bytes per OT
+    const auto bytes = stats_sender.snapshot().bytes_sent + stats_receiver.snapshot().bytes_sent;
+    ASSERT_LT(bytes, number_ots * 2);
+}
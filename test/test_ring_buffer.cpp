@@ -0,0 +1,113 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+#include "util/ring_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(RingBuffer_Test, SPSCTryPushPop)
+{
+    SPSCRingBuffer<std::unique_ptr<int>> buffer(3);
+    ASSERT_EQ(buffer.capacity(), 4);
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(buffer.try_push(std::make_unique<int>(i)));
+    }
+    ASSERT_FALSE(buffer.try_push(std::make_unique<int>(4)));
+    std::unique_ptr<int> item;
+    for (int i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(buffer.try_pop(item));
+        ASSERT_EQ(*item, i);
+    }
+    ASSERT_FALSE(buffer.try_pop(item));
+}
+
+TEST(RingBuffer_Test, SPSCBatchedThreads)
+{
+    const size_t n = 100000;
+    SPSCRingBuffer<std::unique_ptr<size_t>> buffer(64);
+    std::thread producer([&buffer]
+        {
+            std::vector<std::unique_ptr<size_t>> batch(37);
+            for (size_t i = 0; i < n; i += batch.size())
+            {
+                auto k = std::min(batch.size(), n - i);
+                for (size_t j = 0; j < k; ++j)
+                    batch[j] = std::make_unique<size_t>(i + j);
+                buffer.push_batch(batch.data(), k);
+            }
+        });
+    std::vector<std::unique_ptr<size_t>> batch(50);
+    size_t expected = 0;
+    while (expected < n)
+    {
+        auto k = buffer.pop_batch(batch.data(), batch.size());
+        ASSERT_GT(k, 0);
+        for (size_t j = 0; j < k; ++j)
+        {
+            ASSERT_EQ(*batch[j], expected++);
+        }
+    }
+    producer.join();
+}
+
+TEST(RingBuffer_Test, MPMCThreads)
+{
+    const size_t number_producers = 3;
+    const size_t number_consumers = 3;
+    const size_t n = 30000;
+    MPMCRingBuffer<std::unique_ptr<size_t>> buffer(16);
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < number_producers; ++p)
+    {
+        threads.emplace_back([&buffer, p]
+            {
+                for (size_t i = p; i < n; i += number_producers)
+                    buffer.push(std::make_unique<size_t>(i));
+            });
+    }
+    std::vector<size_t> sums(number_consumers, 0);
+    for (size_t c = 0; c < number_consumers; ++c)
+    {
+        threads.emplace_back([&buffer, &sums, c]
+            {
+                std::vector<std::unique_ptr<size_t>> batch(5);
+                for (size_t received = 0; received < n / number_consumers;)
+                {
+                    auto k = buffer.pop_batch(batch.data(), std::min(batch.size(), n / number_consumers - received));
+                    for (size_t j = 0; j < k; ++j)
+                        sums[c] += *batch[j];
+                    received += k;
+                }
+            });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    ASSERT_EQ(std::accumulate(sums.begin(), sums.end(), size_t(0)), n * (n - 1) / 2);
+}
@@ -0,0 +1,104 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <boost/asio/thread_pool.hpp>
+#include "util/threading.hpp"
+
+#include <gtest/gtest.h>
+
+TEST(Threading_Test, ParallelForCoversAll)
+{
+    boost::asio::thread_pool thread_pool(3);
+    for (size_t n : {0, 1, 7, 100, 1000})
+    {
+        for (size_t chunk_size : {0, 1, 3, 64, 5000})
+        {
+            for (size_t threads : {1, 2, 4, 16})
+            {
+                std::vector<std::atomic<int>> counts(n);
+                parallel_for(thread_pool, n, threads, chunk_size, [&counts, chunk_size](size_t begin, size_t end)
+                    {
+                        ASSERT_LT(begin, end);
+                        ASSERT_LE(end - begin, std::max<size_t>(chunk_size, 1));
+                        for (size_t i = begin; i < end; ++i)
+                            ++counts[i];
+                    });
+                for (size_t i = 0; i < n; ++i)
+                {
+                    ASSERT_EQ(counts[i], 1) << "n=" << n << ", chunk_size=" << chunk_size << ", threads=" << threads;
+                }
+            }
+        }
+    }
+    thread_pool.join();
+}
+
+TEST(Threading_Test, Compute)
+{
+    boost::asio::thread_pool thread_pool(4);
+    const size_t n = 1000;
+    std::vector<size_t> out(n, 0);
+    compute(thread_pool, n, 4, [&out](size_t i) { out[i] = i * i; });
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(out[i], i * i);
+    }
+    thread_pool.join();
+}
+
+TEST(Threading_Test, ParallelForRethrows)
+{
+    boost::asio::thread_pool thread_pool(4);
+    std::atomic<size_t> processed(0);
+    ASSERT_THROW(parallel_for(thread_pool, 100, 4, 1, [&processed](size_t begin, size_t)
+        {
+            ++processed;
+            if (begin == 42)
+                throw std::runtime_error("failure");
+        }), std::runtime_error);
+    // the remaining chunks are still processed
+    ASSERT_EQ(processed, 100);
+    thread_pool.join();
+}
+
+TEST(Threading_Test, GlobalThreadPool)
+{
+    auto& thread_pool = global_thread_pool();
+    ASSERT_EQ(&thread_pool, &global_thread_pool());
+    ASSERT_THROW(configure_global_thread_pool(GlobalThreadPoolConfig()), std::logic_error);
+
+    const size_t n = 1000;
+    std::vector<std::atomic<int>> counts(n);
+    parallel_for(thread_pool, n, 4, 10, [&counts](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                ++counts[i];
+        });
+    for (size_t i = 0; i < n; ++i)
+    {
+        ASSERT_EQ(counts[i], 1);
+    }
+}
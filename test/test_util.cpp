@@ -0,0 +1,146 @@
+// MIT License
+//
+// Copyright (c) 2018 Lennart Braun
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "curve25519/util.h"
+#include "util/util.hpp"
+
+#include <gtest/gtest.h>
+
+static const std::array<uint8_t, 32> seed_a{{1, 2, 3, 4, 5, 6, 7, 8}};
+static const std::array<uint8_t, 32> seed_b{{8, 7, 6, 5, 4, 3, 2, 1}};
+
+TEST(Random_Test, SeedIsDeterministic)
+{
+    // more than one buffer refill
+    const size_t n = 3 * 4096 + 17;
+    random_seed(seed_a.data());
+    auto out0 = random_bytes(n);
+    random_seed(seed_a.data());
+    auto out1 = random_bytes(n);
+    random_seed(seed_b.data());
+    auto out2 = random_bytes(n);
+    random_reseed();
+
+    ASSERT_EQ(out0, out1);
+    ASSERT_NE(out0, out2);
+}
+
+TEST(Random_Test, SplitRequests)
+{
+    const size_t n = 2 * 4096 + 100;
+    random_seed(seed_a.data());
+    auto whole = random_bytes(n);
+
+    random_seed(seed_a.data());
+    bytes_t parts(n);
+    size_t offset = 0;
+    for (size_t len = 1; offset < n; ++len)
+    {
+        len = std::min(len, n - offset);
+        random_bytes(parts.data() + offset, len);
+        offset += len;
+    }
+    random_reseed();
+
+    ASSERT_EQ(whole, parts);
+}
+
+TEST(Random_Test, ThreadLocal)
+{
+    random_seed(seed_a.data());
+    auto expected = random_bytes(64);
+
+    random_seed(seed_a.data());
+    bytes_t other;
+    // the other thread is seeded from the operating system
+    std::thread t([&other] { other = random_bytes(64); });
+    t.join();
+    auto out = random_bytes(64);
+    random_reseed();
+
+    ASSERT_EQ(out, expected);
+    ASSERT_NE(other, expected);
+}
+
+TEST(Random_Test, Reseed)
+{
+    random_reseed();
+    auto out0 = random_bytes(32);
+    random_reseed();
+    auto out1 = random_bytes(32);
+    ASSERT_NE(out0, out1);
+}
+
+TEST(Random_Test, KnownAnswer)
+{
+    // RFC 8439, A.1, test vectors #1 and #2: the keystream of ChaCha20 with
+    // the all-zero key and nonce for the block counters 0 and 1.  The first
+    // 32 bytes of each refill become the next key and are not output.
+    const std::array<uint8_t, 32> zero_seed{};
+    const bytes_t expected{
+        0xda, 0x41, 0x59, 0x7c, 0x51, 0x57, 0x48, 0x8d, 0x77, 0x24, 0xe0, 0x3f, 0xb8, 0xd8, 0x4a, 0x37,
+        0x6a, 0x43, 0xb8, 0xf4, 0x15, 0x18, 0xa1, 0x1c, 0xc3, 0x87, 0xb6, 0x69, 0xb2, 0xee, 0x65, 0x86,
+        0x9f, 0x07, 0xe7, 0xbe, 0x55, 0x51, 0x38, 0x7a, 0x98, 0xba, 0x97, 0x7c, 0x73, 0x2d, 0x08, 0x0d,
+        0xcb, 0x0f, 0x29, 0xa0, 0x48, 0xe3, 0x65, 0x69, 0x12, 0xc6, 0x53, 0x3e, 0x32, 0xee, 0x7a, 0xed,
+        0x29, 0xb7, 0x21, 0x76, 0x9c, 0xe6, 0x4e, 0x43, 0xd5, 0x71, 0x33, 0xb0, 0x74, 0xd8, 0x39, 0xd5,
+        0x31, 0xed, 0x1f, 0x28, 0x51, 0x0a, 0xfb, 0x45, 0xac, 0xe1, 0x0a, 0x1f, 0x4b, 0x79, 0x4d, 0x6f,
+    };
+    random_seed(zero_seed.data());
+    auto out = random_bytes(expected.size());
+    random_reseed();
+
+    ASSERT_EQ(out, expected);
+}
+
+TEST(Random_Test, ForkReseeds)
+{
+    random_seed(seed_a.data());
+    // the child would continue with the same state without the reseed
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0)
+    {
+        std::array<uint8_t, 32> child_out;
+        random_bytes(child_out.data(), child_out.size());
+        auto written = write(fds[1], child_out.data(), child_out.size());
+        _exit(written == static_cast<ssize_t>(child_out.size()) ? 0 : 1);
+    }
+    close(fds[1]);
+    auto out = random_bytes(32);
+    random_reseed();
+
+    bytes_t child_out(32);
+    ASSERT_EQ(read(fds[0], child_out.data(), child_out.size()), static_cast<ssize_t>(child_out.size()));
+    close(fds[0]);
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    ASSERT_NE(out, child_out);
+}